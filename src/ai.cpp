@@ -1,18 +1,33 @@
-#include <vector>
 #include <limits>
 #include <utility>
 #include <cstdlib>
 #include <algorithm> 
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
-struct Move {
-    int fromRow, fromCol;
-    int toRow, toCol;
-    int score; 
-};
+// ──────────────────────────────────────────────
+// ALLOCATION CHECK (build with -DCOUNT_ALLOCATIONS)
+// ──────────────────────────────────────────────
+// Counts every global operator new so getBestMove can report how many heap
+// allocations the search made. The search is expected to make none.
+#ifdef COUNT_ALLOCATIONS
+#include <new>
+#include <iostream>
+long long heapAllocations = 0;
 
-// Forward Declarations
-std::vector<std::pair<int,int>> getLegalMoves(int row, int col, int board[8][8]);
-bool isSquareAttacked(int targetRow, int targetCol, bool attackerIsWhite, int board[8][8]);
+void* operator new(std::size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
 
 // ──────────────────────────────────────────────
 // GLOBALS & CONSTANTS
@@ -20,6 +35,25 @@ bool isSquareAttacked(int targetRow, int targetCol, bool attackerIsWhite, int bo
 // Piece Values: 0, Rook, Knight, Bishop, Queen, King, Pawn
 const int PIECE_VALUES[7] = {0, 500, 320, 330, 900, 20000, 100};
 
+// Search scores must fit the transposition table's 16 bits
+const int INFINITY_SCORE = 32000;
+const int MATE_SCORE = 31000;  // Mate at the root; mate in N plies is MATE_SCORE - N
+const int MATE_BOUND = 30000;  // Anything beyond this is a forced mate
+const int MAX_PLY = 128;
+
+// Mate scores are stored relative to the entry's node, not the root, so a
+// transposition reached at a different ply still reads the right distance.
+inline int scoreToTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+inline int scoreFromTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
 // PIECE-SQUARE TABLES (Bonus Points for Position)
 int pawnTable[8][8] = {
     { 0,  0,  0,  0,  0,  0,  0,  0},
@@ -87,176 +121,1046 @@ int kingTable[8][8] = {
     { 20, 30, 10,  0,  0, 10, 30, 20}
 };
 
+// ──────────────────────────────────────────────
+// STATIC EXCHANGE EVALUATION
+// ──────────────────────────────────────────────
+// Material won or lost by the sequence of captures a move starts on its
+// target square, each side recapturing with its least valuable piece and
+// free to stop when going on would lose more. Sliders lined up behind an
+// attacker (x-rays) join in once the piece in front has captured. Pins
+// are ignored.
+int see(const Position& pos, Move move) {
+    int from = moveFrom(move), to = moveTo(move);
+    int side = colorOf(pos.squares[from]);
+    int gain[32];
+    int depth = 0;
+
+    Bitboard occupied = pos.allPieces ^ squareBB(from);
+    int onSquare = abs(pos.squares[from]); // Piece that can be taken next
+    gain[0] = PIECE_VALUES[abs(pos.squares[to])];
+    if (moveFlag(move) == MOVE_EN_PASSANT) {
+        gain[0] = PIECE_VALUES[PAWN];
+        occupied ^= squareBB(side == WHITE ? to + 8 : to - 8);
+    }
+    if (isPromotion(move)) {
+        onSquare = promotionType(move);
+        gain[0] += PIECE_VALUES[onSquare] - PIECE_VALUES[PAWN];
+    }
+
+    Bitboard diagonal = pos.pieces[WHITE][BISHOP] | pos.pieces[BLACK][BISHOP] | pos.pieces[WHITE][QUEEN] | pos.pieces[BLACK][QUEEN];
+    Bitboard straight = pos.pieces[WHITE][ROOK] | pos.pieces[BLACK][ROOK] | pos.pieces[WHITE][QUEEN] | pos.pieces[BLACK][QUEEN];
+    Bitboard attackers = attackersTo(pos, to, occupied) & occupied;
+    const int cheapestFirst[6] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+    while (true) {
+        side ^= 1;
+        Bitboard ours = attackers & pos.occupied[side];
+        if (!ours) break;
+
+        int type = KING;
+        for (int t : cheapestFirst) {
+            if (ours & pos.pieces[side][t]) { type = t; break; }
+        }
+        // The king may only take last
+        if (type == KING && (attackers & pos.occupied[side ^ 1])) break;
+
+        depth++;
+        gain[depth] = PIECE_VALUES[onSquare] - gain[depth - 1];
+        // Stand pat beats capturing whatever happens next: stop here
+        if (std::max(-gain[depth - 1], gain[depth]) < 0) { depth--; break; }
+
+        occupied ^= squareBB(bitScan(ours & pos.pieces[side][type]));
+        if (type == PAWN || type == BISHOP || type == QUEEN) attackers |= bishopAttacks(to, occupied) & diagonal;
+        if (type == ROOK || type == QUEEN) attackers |= rookAttacks(to, occupied) & straight;
+        attackers &= occupied;
+        onSquare = type;
+    }
+
+    // Walk back up: each side takes the better of stopping or recapturing
+    while (depth > 0) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
+
+// ──────────────────────────────────────────────
+// QUIET MOVE HEURISTICS
+// ──────────────────────────────────────────────
+// Quiet moves have no capture to rank them by, so the search remembers
+// which ones caused beta cutoffs:
+//  - killers: the last two quiet cutoff moves at each ply
+//  - history: [side][from][to] score, raised for a quiet move that cuts
+//    off and lowered for the quiet moves tried before it
+//  - countermoves: the quiet move that last refuted a given previous move
+// Every search thread has its own set.
+const int HISTORY_MAX = 16384;
+
+struct OrderingTables {
+    Move killers[MAX_PLY][2];
+    int history[2][64][64];
+    Move counterMoves[64][64]; // Indexed by the previous move's from/to
+};
+
+inline bool isQuiet(const Position& pos, Move m) {
+    return pos.squares[moveTo(m)] == 0 && moveFlag(m) != MOVE_EN_PASSANT && !isPromotion(m);
+}
+
+// Whether a quiet move checks the enemy king, found without making it:
+// directly from the landing square, or by a slider behind the piece that
+// left. Castling can only check with the rook.
+bool quietGivesCheck(const Position& pos, Move m) {
+    int from = moveFrom(m), to = moveTo(m);
+    int piece = pos.squares[from], type = abs(piece);
+    int us = colorOf(piece);
+    int kingSq = kingSquare(pos, us ^ 1);
+    const Bitboard *p = pos.pieces[us];
+
+    if (type == PAWN && (PAWN_ATTACKS[us][to] & squareBB(kingSq))) return true;
+    if (type == KNIGHT && (KNIGHT_ATTACKS[to] & squareBB(kingSq))) return true;
+
+    Bitboard occupied = (pos.allPieces & ~squareBB(from)) | squareBB(to);
+    Bitboard diagonal = (p[BISHOP] | p[QUEEN]) & ~squareBB(from);
+    Bitboard straight = (p[ROOK] | p[QUEEN]) & ~squareBB(from);
+    if (type == BISHOP || type == QUEEN) diagonal |= squareBB(to);
+    if (type == ROOK || type == QUEEN) straight |= squareBB(to);
+    if (moveFlag(m) == MOVE_CASTLING) {
+        int row = rowOf(to);
+        Bitboard rookFrom = squareBB(squareOf(row, colOf(to) == 6 ? 7 : 0));
+        Bitboard rookTo = squareBB(squareOf(row, colOf(to) == 6 ? 5 : 3));
+        occupied = (occupied & ~rookFrom) | rookTo;
+        straight = (straight & ~rookFrom) | rookTo;
+    }
+    return (bishopAttacks(kingSq, occupied) & diagonal) || (rookAttacks(kingSq, occupied) & straight);
+}
+
+inline Move previousMove(const Position& pos) {
+    return pos.historyCount > 0 ? pos.history[pos.historyCount - 1].move : NO_MOVE;
+}
+
+// Gravity update: the closer an entry is to HISTORY_MAX, the less a bonus
+// moves it, so scores stay bounded and recent results count most
+inline void updateHistory(int& entry, int bonus) {
+    entry += bonus - entry * abs(bonus) / HISTORY_MAX;
+}
+
+void updateQuietHeuristics(OrderingTables& o, const Position& pos, Move best, int depth, int ply, const Move* tried, int triedCount) {
+    if (o.killers[ply][0] != best) {
+        o.killers[ply][1] = o.killers[ply][0];
+        o.killers[ply][0] = best;
+    }
+
+    int side = pos.whiteToMove ? WHITE : BLACK;
+    int bonus = std::min(depth * depth, 400);
+    updateHistory(o.history[side][moveFrom(best)][moveTo(best)], bonus);
+    for (int i = 0; i < triedCount; i++)
+        updateHistory(o.history[side][moveFrom(tried[i])][moveTo(tried[i])], -bonus);
+
+    Move previous = previousMove(pos);
+    if (previous != NO_MOVE) o.counterMoves[moveFrom(previous)][moveTo(previous)] = best;
+}
+
+// Killers belong to one search; history is halved so it adapts to the new position
+void resetQuietHeuristics(OrderingTables& o) {
+    for (int ply = 0; ply < MAX_PLY; ply++) o.killers[ply][0] = o.killers[ply][1] = NO_MOVE;
+    for (int side = 0; side < 2; side++)
+        for (int from = 0; from < 64; from++)
+            for (int to = 0; to < 64; to++) o.history[side][from][to] /= 2;
+}
+
+// Lazy SMP helpers get a little noise on top, different for every thread,
+// so they try equally rated quiet moves in different orders and walk
+// different parts of the tree. Thread 0 keeps the plain ordering.
+const int HISTORY_NOISE = 64;
+
+void addHistoryNoise(OrderingTables& o, int threadId) {
+    uint64_t x = 0x9E3779B97F4A7C15ULL * (uint64_t)threadId;
+    for (int side = 0; side < 2; side++)
+        for (int from = 0; from < 64; from++)
+            for (int to = 0; to < 64; to++) {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                int& h = o.history[side][from][to];
+                h = std::min(HISTORY_MAX, h + (int)(x % HISTORY_NOISE));
+            }
+}
+
 // ──────────────────────────────────────────────
 // OPTIMIZATION: Move Ordering
 // ──────────────────────────────────────────────
+// Sort moves: Highest score first. Insertion sort keeps the move and
+// score arrays in step and is quick for lists this short. It is stable,
+// so moves with equal scores keep their generation order.
+void sortMoves(MoveList& moves) {
+    for (int i = 1; i < moves.size(); i++) {
+        Move move = moves.moves[i];
+        int score = moves.scores[i];
+        int j = i - 1;
+        while (j >= 0 && moves.scores[j] < score) {
+            moves.moves[j + 1] = moves.moves[j];
+            moves.scores[j + 1] = moves.scores[j];
+            j--;
+        }
+        moves.moves[j + 1] = move;
+        moves.scores[j + 1] = score;
+    }
+}
+
 // Assigns a score to each move so we can sort them.
 // High Score = Check this move first (Optimizes Alpha-Beta)
-void orderMoves(std::vector<Move>& moves, int board[8][8]) {
-    for (auto& move : moves) {
+// Captures that lose material by SEE go after the quiet moves. Quiet
+// moves are ranked killers, then the countermove, then by history.
+const int GOOD_CAPTURE = 100000;
+const int KILLER_SCORE = 90000;
+const int COUNTER_SCORE = 80000;
+const int BAD_CAPTURE = -100000;
+
+void orderMoves(MoveList& moves, const Position& pos, const OrderingTables& o, Move ttMove = NO_MOVE, int ply = 0) {
+    int side = pos.whiteToMove ? WHITE : BLACK;
+    Move previous = previousMove(pos);
+    Move counter = previous != NO_MOVE ? o.counterMoves[moveFrom(previous)][moveTo(previous)] : NO_MOVE;
+
+    for (int i = 0; i < moves.size(); i++) {
+        Move move = moves[i];
         int moveScore = 0;
-        int victim = abs(board[move.toRow][move.toCol]);
-        int attacker = abs(board[move.fromRow][move.fromCol]);
 
-        // 1. Prioritize Captures (MVV-LVA: Most Valuable Victim - Least Valuable Attacker)
-        if (victim != 0) {
-            moveScore = 10 * PIECE_VALUES[victim] - PIECE_VALUES[attacker];
+        // 0. The transposition table's best move goes before everything
+        if (move == ttMove) {
+            moves.scores[i] = 1000000;
+            continue;
         }
+        int victim = moveFlag(move) == MOVE_EN_PASSANT ? PAWN : abs(pos.squares[moveTo(move)]);
+        int attacker = abs(pos.squares[moveFrom(move)]);
 
-        move.score = moveScore;
-    }
+        if (victim != 0 || isPromotion(move)) {
+            // 1. Prioritize Captures (MVV-LVA: Most Valuable Victim - Least Valuable Attacker)
+            if (victim != 0) moveScore = 10 * PIECE_VALUES[victim] - PIECE_VALUES[attacker];
+            // 2. Promotions gain the new piece's value
+            if (isPromotion(move)) moveScore += PIECE_VALUES[promotionType(move)];
+
+            // Taking something worth at least the attacker can never lose
+            bool losing = PIECE_VALUES[victim] < PIECE_VALUES[attacker] && see(pos, move) < 0;
+            moveScore += losing ? BAD_CAPTURE : GOOD_CAPTURE;
+        }
+        // 3. Quiet moves
+        else if (move == o.killers[ply][0]) moveScore = KILLER_SCORE;
+        else if (move == o.killers[ply][1]) moveScore = KILLER_SCORE - 1;
+        else if (move == counter) moveScore = COUNTER_SCORE;
+        else moveScore = o.history[side][moveFrom(move)][moveTo(move)];
 
-    // Sort moves: Highest score first
-    std::sort(moves.begin(), moves.end(), [](const Move& a, const Move& b) {
-        return a.score > b.score;
-    });
+        moves.scores[i] = moveScore;
+    }
+    sortMoves(moves);
 }
 
 // ──────────────────────────────────────────────
 // EVALUATION FUNCTION
 // ──────────────────────────────────────────────
-int evaluateBoard(int board[8][8]) {
-    int score = 0;
+// Piece-square tables indexed by piece code, read from White's point of view
+int (*const PIECE_TABLES[7])[8] = {nullptr, rookTable, knightTable, bishopTable, queenTable, kingTable, pawnTable};
 
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            int piece = board[r][c];
-            if (piece == 0) continue;
+int evaluateBoard(const Position& pos) {
+    int score = 0;
 
-            int absPiece = abs(piece);
-            int baseValue = PIECE_VALUES[absPiece];
-            int positionBonus = 0;
+    for (int type = ROOK; type <= PAWN; type++) {
+        int baseValue = PIECE_VALUES[type];
+        int (*table)[8] = PIECE_TABLES[type];
 
-            int tableRow = (piece > 0) ? r : (7 - r);
+        // Material comes straight from the piece counts
+        score += baseValue * (popCount(pos.pieces[WHITE][type]) - popCount(pos.pieces[BLACK][type]));
 
-            switch(absPiece) {
-                case 1: positionBonus = rookTable[tableRow][c]; break;
-                case 2: positionBonus = knightTable[tableRow][c]; break;
-                case 3: positionBonus = bishopTable[tableRow][c]; break;
-                case 4: positionBonus = queenTable[tableRow][c]; break;
-                case 5: positionBonus = kingTable[tableRow][c]; break;
-                case 6: positionBonus = pawnTable[tableRow][c]; break;
-            }
-
-            if (piece > 0) score += (baseValue + positionBonus);
-            else score -= (baseValue + positionBonus);
+        Bitboard b = pos.pieces[WHITE][type];
+        while (b) {
+            int sq = popLsb(b);
+            score += table[rowOf(sq)][colOf(sq)];
+        }
+        // Tables are mirrored for Black
+        b = pos.pieces[BLACK][type];
+        while (b) {
+            int sq = popLsb(b);
+            score -= table[7 - rowOf(sq)][colOf(sq)];
         }
     }
     return score;
 }
 
-std::vector<Move> generateAllMoves(int board[8][8], bool whiteTurn) {
-    std::vector<Move> moves;
-    // Reserve memory to avoid reallocations (Optimization)
-    moves.reserve(30); 
+// Knights, bishops, rooks and queens of one side. With none left, zugzwang
+// is common and passing the move is no longer a safe assumption.
+int nonPawnMaterial(const Position& pos, int side) {
+    int material = 0;
+    for (int type = ROOK; type <= QUEEN; type++)
+        material += PIECE_VALUES[type] * popCount(pos.pieces[side][type]);
+    return material;
+}
 
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            int piece = board[r][c];
-            if (piece == 0) continue;
-            if (whiteTurn && piece < 0) continue;
-            if (!whiteTurn && piece > 0) continue;
+void generateAllMoves(const Position& pos, bool whiteTurn, MoveList& moves) {
+    // Stack-allocated list, no reallocations (Optimization)
+    moves.clear();
+    generateLegalMoves(pos, whiteTurn, moves);
+}
 
-            std::vector<std::pair<int, int>> legal = getLegalMoves(r, c, board);
-            for (auto &m : legal) {
-                moves.push_back({r, c, m.first, m.second, 0});
-            }
+// ──────────────────────────────────────────────
+// SEARCH CONTROL
+// ──────────────────────────────────────────────
+// getBestMove deepens one ply at a time until a limit runs out. A zero
+// limit means "no limit"; with none set the search stops at maxDepth.
+// Another thread can end the search early by setting *stop; getBestMove
+// then returns the move from the last completed iteration. While *ponder
+// is set the time budget is not enforced; once it is cleared (a ponder
+// hit) the time already spent counts against the budget.
+struct SearchInfo;
+struct SearchLimits {
+    int timeMs = 0;       // Wall-clock budget in milliseconds
+    long long nodes = 0;  // Node budget
+    int maxDepth = 64;
+    const std::atomic<bool>* stop = nullptr;
+    const std::atomic<bool>* ponder = nullptr;
+    // Called on the searching thread after each completed iteration
+    void (*onIteration)(const SearchInfo& progress, Move best) = nullptr;
+};
+
+// What the search found. depth and score come from the last completed
+// iteration; the cutoff counts cover the whole search.
+struct SearchInfo {
+    int depth = 0;
+    int score = 0;         // From the side to move's point of view
+    long long nodes = 0;
+    int timeMs = 0;
+    long long cutoffs = 0;          // Beta cutoffs in negamax
+    long long firstMoveCutoffs = 0; // ... made by the first move searched
+
+    // Forward pruning: nodes cut off, or moves skipped, by each technique
+    long long nullMoveCutoffs = 0;
+    long long reverseFutilityCutoffs = 0;
+    long long razorCutoffs = 0;
+    long long futilityPruned = 0;
+    long long lateMovePruned = 0;
+
+    // Extensions granted
+    long long checkExtensions = 0;
+    long long recaptureExtensions = 0;
+    long long singularExtensions = 0;
+
+    long long ttProbes = 0;
+    long long ttHits = 0;
+    int threads = 1;
+
+    int firstMoveCutoffPercent() const { return cutoffs ? (int)(firstMoveCutoffs * 100 / cutoffs) : 0; }
+    int ttHitRate() const { return ttProbes ? (int)(ttHits * 100 / ttProbes) : 0; }
+
+    // Adds another thread's counters to these
+    void addCounters(const SearchInfo& other) {
+        nodes += other.nodes;
+        cutoffs += other.cutoffs;
+        firstMoveCutoffs += other.firstMoveCutoffs;
+        nullMoveCutoffs += other.nullMoveCutoffs;
+        reverseFutilityCutoffs += other.reverseFutilityCutoffs;
+        razorCutoffs += other.razorCutoffs;
+        futilityPruned += other.futilityPruned;
+        lateMovePruned += other.lateMovePruned;
+        checkExtensions += other.checkExtensions;
+        recaptureExtensions += other.recaptureExtensions;
+        singularExtensions += other.singularExtensions;
+        ttProbes += other.ttProbes;
+        ttHits += other.ttHits;
+    }
+};
+
+typedef std::chrono::steady_clock SearchClock;
+
+// Root aspiration window, doubled on every fail high or fail low
+const int ASPIRATION_WINDOW = 25;
+const int ASPIRATION_MIN_DEPTH = 4; // Shallow scores swing too much to aim at
+
+// Quiescence skips a capture when even winning the piece plus this margin
+// would leave the score below alpha
+const int DELTA_MARGIN = 200;
+
+// Null move: searched NULL_MOVE_REDUCTION + depth / 4 plies shallower.
+// Below NULL_VERIFY_MATERIAL (a rook and a minor) a null-move cutoff is
+// confirmed by a normal reduced search, since zugzwang gets likely.
+const int NULL_MOVE_MIN_DEPTH = 3;
+const int NULL_MOVE_REDUCTION = 2;
+const int NULL_VERIFY_MATERIAL = 830;
+
+// Late move reductions: quiet moves from LMR_MIN_MOVE on are searched
+// LMR_TABLE[depth][moveNumber] plies shallower, growing with the log of
+// both. Late move pruning: at depth LMP_MAX_DEPTH or less, quiet moves
+// after the first 3 + depth * depth are not searched at all.
+const int LMR_MIN_DEPTH = 3;
+const int LMR_MIN_MOVE = 3;
+const int LMP_MAX_DEPTH = 3;
+int LMR_TABLE[64][64];
+
+// Shallow-depth forward pruning against the static evaluation, indexed by
+// remaining depth:
+//  - reverse futility: at depth <= 3, cut off when the eval beats beta by
+//    REVERSE_FUTILITY_MARGIN per ply
+//  - razoring: at depth <= 2, drop into quiescence when the eval is
+//    RAZOR_MARGIN below alpha, and trust it if it fails low too
+//  - futility: at depth <= 2, skip late quiet moves when the eval plus
+//    FUTILITY_MARGIN still cannot reach alpha
+const int REVERSE_FUTILITY_MAX_DEPTH = 3;
+const int REVERSE_FUTILITY_MARGIN = 120;
+const int RAZOR_MAX_DEPTH = 2;
+const int RAZOR_MARGIN[RAZOR_MAX_DEPTH + 1] = {0, 300, 550};
+const int FUTILITY_MAX_DEPTH = 2;
+const int FUTILITY_MARGIN[FUTILITY_MAX_DEPTH + 1] = {0, 150, 300};
+
+// Extensions: a move that gives check, recaptures on the square the
+// opponent just took on, or is singular (the TT move, when every other
+// move falls SINGULAR_MARGIN per ply short of its score) is searched one
+// ply deeper. No line gets more than MAX_LINE_EXTENSIONS in total.
+const int MAX_LINE_EXTENSIONS = 8;
+const int SINGULAR_MIN_DEPTH = 8;
+const int SINGULAR_MARGIN = 2;
+
+// Per-ply state along the current line
+struct PlyState {
+    Move excludedMove; // Skipped at this ply during a singular extension test
+    int extensions;    // Plies of extension on the way from the root
+};
+
+void initLMR() {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+
+    for (int depth = 0; depth < 64; depth++)
+        for (int move = 0; move < 64; move++)
+            LMR_TABLE[depth][move] = (depth && move) ? (int)(0.75 + std::log(depth) * std::log(move) / 2.25) : 0;
+}
+
+// ──────────────────────────────────────────────
+// SEARCH THREADS (LAZY SMP)
+// ──────────────────────────────────────────────
+// Every thread runs its own iterative deepening on its own copy of the
+// position, with its own ordering tables. They only share the
+// transposition table, so each thread finds the others' results there
+// and skips work they have already done. Helpers start at different
+// depths and with slightly different move ordering, so the threads do not
+// all walk the tree in lockstep.
+//
+// Thread 0 is whoever called getBestMove. It alone watches the clock and
+// node budget, and tells the helpers to stop when it is done.
+struct Search;
+
+struct SearchThread {
+    Search* search = nullptr; // The search this thread works for
+    int id = 0;
+    Position pos;
+    OrderingTables ordering;
+    PlyState plyState[MAX_PLY + 1];
+    std::atomic<long long> nodes{0};
+    SearchInfo info;          // This thread's counters and last completed depth
+    Move bestMove = NO_MOVE;  // ...and the move it found there
+};
+
+// One search: its limits, clock, stop flag and the threads working on it.
+// getBestMove runs defaultSearch. Batch analysis gives each worker its own
+// single-threaded Search, so unrelated positions are searched side by side.
+struct Search {
+    SearchLimits limits;
+    SearchClock::time_point start;
+    std::atomic<bool> stopped{false};
+    SearchInfo info;     // Result of the last search, counters summed over all threads
+    bool agesTT = true;  // Batch workers share one table age for the whole batch
+
+    std::vector<SearchThread*> threads; // [0] is the calling thread
+    std::vector<std::thread> helpers;
+    std::mutex poolMutex;
+    std::condition_variable poolWake, poolDone;
+    int poolGeneration = 0; // Bumped to start the helpers on a new search
+    int helpersRunning = 0;
+    bool poolQuit = false;
+
+    ~Search();
+};
+
+Search defaultSearch;
+SearchInfo searchInfo; // Result of the last getBestMove
+
+inline int elapsedMs(const Search& s) {
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(SearchClock::now() - s.start).count();
+}
+
+// The time budget applies unless the search is pondering
+inline bool timeLimited(const Search& s) {
+    return s.limits.timeMs && !(s.limits.ponder && s.limits.ponder->load(std::memory_order_relaxed));
+}
+
+// Counts a node. Reading the clock costs more than a node, so thread 0
+// only looks at it every 1024 nodes. Once set, the stopped flag unwinds
+// every thread's tree.
+inline void countNode(SearchThread& t) {
+    long long nodes = t.nodes.load(std::memory_order_relaxed) + 1;
+    t.nodes.store(nodes, std::memory_order_relaxed);
+    if (t.id != 0 || (nodes & 1023) != 0) return;
+
+    Search& s = *t.search;
+    long long total = 0;
+    for (SearchThread* other : s.threads) total += other->nodes.load(std::memory_order_relaxed);
+    if ((s.limits.nodes && total >= s.limits.nodes) ||
+        (timeLimited(s) && elapsedMs(s) >= s.limits.timeMs) ||
+        (s.limits.stop && s.limits.stop->load(std::memory_order_relaxed)))
+        s.stopped = true;
+}
+
+// ──────────────────────────────────────────────
+// QUIESCENCE SEARCH
+// ──────────────────────────────────────────────
+// Evaluating in the middle of an exchange misjudges the position badly, so
+// at the horizon only captures and promotions are searched until things
+// are quiet. The side to move may also "stand pat" on the static score,
+// since it is never forced to capture. In check there is no standing pat:
+// every evasion is searched, which also finds mates at the horizon.
+int quiescence(SearchThread& t, int alpha, int beta, int ply) {
+    Position& pos = t.pos;
+    countNode(t);
+    if (t.search->stopped) return 0;
+
+    int eval = evaluateBoard(pos);
+    int standPat = pos.whiteToMove ? eval : -eval;
+    if (ply >= MAX_PLY) return standPat;
+
+    bool inCheck = isSquareAttacked(pos, kingSquare(pos, pos.whiteToMove ? WHITE : BLACK), !pos.whiteToMove);
+    int bestScore = -INFINITY_SCORE;
+    MoveList moves;
+
+    if (inCheck) {
+        generateAllMoves(pos, pos.whiteToMove, moves);
+        if (moves.empty()) return -MATE_SCORE + ply;
+    } else {
+        if (standPat >= beta) return standPat;
+        if (standPat > alpha) alpha = standPat;
+        bestScore = standPat;
+        generateLegalMoves(pos, pos.whiteToMove, moves, true);
+    }
+
+    orderMoves(moves, pos, t.ordering, NO_MOVE, ply);
+
+    for (int i = 0; i < moves.size(); i++) {
+        Move m = moves[i];
+
+        // Losing captures are sorted last, so the rest are not worth trying
+        if (!inCheck && moves.scores[i] < 0) break;
+
+        // Delta pruning: hopeless captures are not worth a node
+        if (!inCheck && !isPromotion(m)) {
+            int victim = moveFlag(m) == MOVE_EN_PASSANT ? PAWN : abs(pos.squares[moveTo(m)]);
+            if (standPat + PIECE_VALUES[victim] + DELTA_MARGIN <= alpha) continue;
+        }
+
+        makeMove(pos, m);
+        int score = -quiescence(t, -beta, -alpha, ply + 1);
+        unmakeMove(pos);
+        if (t.search->stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) break;
         }
     }
-    return moves;
+    return bestScore;
 }
 
 // ──────────────────────────────────────────────
-// MINIMAX WITH ALPHA-BETA & MOVE ORDERING
+// NEGAMAX PRINCIPAL VARIATION SEARCH
 // ──────────────────────────────────────────────
-int minimax(int board[8][8], int depth, bool maximizing, int alpha, int beta) {
-    std::vector<Move> moves = generateAllMoves(board, maximizing);
+// Scores are from the side to move's point of view, so one routine serves
+// both colors: a child's score is negated on the way back up. ply counts
+// from the root. A stopped search returns 0, which callers must throw away.
+//
+// The first move gets the full (alpha, beta) window. Move ordering makes it
+// the best one most of the time, so later moves are only asked "is this
+// better than alpha?" with a null window, which is far cheaper. The rare
+// move that answers yes is searched again with the full window.
+//
+// allowNull is false right after a null move and inside a null-move
+// verification search.
+int negamax(SearchThread& t, int depth, int alpha, int beta, int ply, bool allowNull = true) {
+    if (depth <= 0) return quiescence(t, alpha, beta, ply);
 
-    if (moves.empty()) {
-        int kingRow = -1, kingCol = -1;
-        int kingVal = maximizing ? 5 : -5;
-        for(int r=0; r<8; r++) {
-            for(int c=0; c<8; c++) {
-                if(board[r][c] == kingVal) { kingRow=r; kingCol=c; }
-            }
+    Position& pos = t.pos;
+    PlyState* plyState = t.plyState;
+    SearchInfo& info = t.info;
+    countNode(t);
+    if (t.search->stopped) return 0;
+
+    // Transposition table: cut off if a deep enough result is stored,
+    // otherwise remember its best move to search first. A singular test
+    // searches this node without its best move, so it must not cut off on
+    // or overwrite the real entry.
+    Move excluded = plyState[ply].excludedMove;
+    Move ttMove = NO_MOVE;
+    int ttScore = 0, ttBound = BOUND_NONE, ttDepth = 0;
+    TTEntry entry;
+    if (excluded == NO_MOVE) info.ttProbes++;
+    if (excluded == NO_MOVE && probeTT(pos.key, entry)) {
+        info.ttHits++;
+        ttMove = entry.move;
+        ttScore = scoreFromTT(entry.score, ply);
+        ttBound = entry.boundAge & 3;
+        ttDepth = entry.depth;
+        if (ttDepth >= depth &&
+            (ttBound == BOUND_EXACT ||
+             (ttBound == BOUND_LOWER && ttScore >= beta) ||
+             (ttBound == BOUND_UPPER && ttScore <= alpha)))
+            return ttScore;
+    }
+
+    int side = pos.whiteToMove ? WHITE : BLACK;
+    bool inCheck = isSquareAttacked(pos, kingSquare(pos, side), !pos.whiteToMove);
+    bool pvNode = beta - alpha > 1;
+
+    // Static evaluation for the pruning decisions below; meaningless in check
+    int staticEval = -INFINITY_SCORE;
+    if (!inCheck) {
+        int eval = evaluateBoard(pos);
+        staticEval = pos.whiteToMove ? eval : -eval;
+    }
+
+    // Reverse futility: so far above beta that no reply will bring it back
+    if (!pvNode && !inCheck && excluded == NO_MOVE && depth <= REVERSE_FUTILITY_MAX_DEPTH && abs(beta) < MATE_BOUND &&
+        staticEval - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+        info.reverseFutilityCutoffs++;
+        return staticEval;
+    }
+
+    // Razoring: so far below alpha that only captures could help
+    if (!pvNode && !inCheck && excluded == NO_MOVE && depth <= RAZOR_MAX_DEPTH && alpha > -MATE_BOUND &&
+        staticEval + RAZOR_MARGIN[depth] <= alpha) {
+        int score = quiescence(t, alpha, alpha + 1, ply);
+        if (t.search->stopped) return 0;
+        if (score <= alpha) {
+            info.razorCutoffs++;
+            return score;
         }
-        if (isSquareAttacked(kingRow, kingCol, !maximizing, board)) {
-            return maximizing ? -9999999 - depth : 9999999 + depth;
+    }
+
+    // Null-move pruning: if passing still leaves us at or above beta, a real
+    // move would too, so cut off after a much shallower search. Not in
+    // check (passing would be illegal), and not without pieces (zugzwang).
+    if (allowNull && !inCheck && depth >= NULL_MOVE_MIN_DEPTH && abs(beta) < MATE_BOUND && ply < MAX_PLY) {
+        int material = nonPawnMaterial(pos, side);
+        if (material > 0 && staticEval >= beta) {
+            int reduction = NULL_MOVE_REDUCTION + depth / 4;
+            plyState[ply + 1].extensions = plyState[ply].extensions;
+            makeNullMove(pos);
+            int score = -negamax(t, depth - 1 - reduction, -beta, -beta + 1, ply + 1, false);
+            unmakeNullMove(pos);
+            if (t.search->stopped) return 0;
+
+            if (score >= beta) {
+                if (score >= MATE_BOUND) score = beta; // A mate found by passing proves nothing
+                if (material >= NULL_VERIFY_MATERIAL ||
+                    negamax(t, depth - 1 - reduction, beta - 1, beta, ply, false) >= beta) {
+                    info.nullMoveCutoffs++;
+                    return score;
+                }
+                if (t.search->stopped) return 0;
+            }
         }
+    }
+
+    MoveList moves;
+    generateAllMoves(pos, pos.whiteToMove, moves);
+
+    if (moves.empty()) {
+        if (inCheck) return -MATE_SCORE + ply;
         return 0; // Stalemate
     }
-    
-    if (depth == 0) return evaluateBoard(board);
 
-    // NEW: Order moves to make Alpha-Beta effective
-    orderMoves(moves, board);
+    if (ply >= MAX_PLY) {
+        int eval = evaluateBoard(pos);
+        return pos.whiteToMove ? eval : -eval;
+    }
 
-    if (maximizing) { // White
-        int maxEval = -99999999;
-        for (auto &m : moves) {
-            int captured = board[m.toRow][m.toCol];
-            int movingPiece = board[m.fromRow][m.fromCol];
+    orderMoves(moves, pos, t.ordering, ttMove, ply);
 
-            board[m.toRow][m.toCol] = movingPiece;
-            board[m.fromRow][m.fromCol] = 0;
+    int alphaOrig = alpha;
+    Move bestMove = NO_MOVE;
+    int bestScore = -INFINITY_SCORE;
+    Move quietsTried[64];
+    int quietCount = 0;
+    bool futile = !pvNode && depth <= FUTILITY_MAX_DEPTH && !inCheck && staticEval + FUTILITY_MARGIN[depth] <= alpha;
+    bool canExtend = plyState[ply].extensions < MAX_LINE_EXTENSIONS;
+    bool singularCandidate = canExtend && depth >= SINGULAR_MIN_DEPTH && ttMove != NO_MOVE &&
+                             ttDepth >= depth - 3 && (ttBound & BOUND_LOWER) && abs(ttScore) < MATE_BOUND;
+    Move previous = previousMove(pos);
+    bool previousCaptured = previous != NO_MOVE && pos.history[pos.historyCount - 1].captured != 0;
 
-            int eval = minimax(board, depth - 1, false, alpha, beta);
+    for (int i = 0; i < moves.size(); i++) {
+        Move m = moves[i];
+        if (m == excluded) continue;
+        bool quiet = isQuiet(pos, m);
+        int extension = 0;
 
-            board[m.fromRow][m.fromCol] = movingPiece;
-            board[m.toRow][m.toCol] = captured;
+        // Singular extension: search everything but the TT move at reduced
+        // depth; if nothing comes close to its score, it is the only move
+        // and deserves an extra ply
+        if (m == ttMove && singularCandidate) {
+            int singularBeta = ttScore - SINGULAR_MARGIN * depth;
+            plyState[ply].excludedMove = m;
+            int score = negamax(t, (depth - 1) / 2, singularBeta - 1, singularBeta, ply, false);
+            plyState[ply].excludedMove = NO_MOVE;
+            if (t.search->stopped) return 0;
+            if (score < singularBeta) {
+                extension = 1;
+                info.singularExtensions++;
+            }
+        }
+        bool recapture = previousCaptured && !quiet && moveTo(m) == moveTo(previous);
+        bool quietCheck = quiet && quietGivesCheck(pos, m);
 
-            maxEval = std::max(maxEval, eval);
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) break; // Pruning
+        // Captures, promotions, killers and checks are never reduced or pruned
+        bool lateQuiet = quiet && !inCheck && !quietCheck &&
+                         m != t.ordering.killers[ply][0] && m != t.ordering.killers[ply][1];
+
+        // Futility: a quiet move cannot make up the gap to alpha here.
+        // Late move pruning: this far down a well-ordered list at the
+        // horizon, a quiet move is very unlikely to raise alpha. Neither at
+        // PV nodes, where the list may not be ordered yet and every move
+        // counts. Both are decided before the move is made.
+        if (lateQuiet && i > 0 && bestScore > -MATE_BOUND) {
+            if (futile) {
+                info.futilityPruned++;
+                continue;
+            }
+            if (!pvNode && depth <= LMP_MAX_DEPTH && i >= 3 + depth * depth) {
+                info.lateMovePruned++;
+                continue;
+            }
         }
-        return maxEval;
-    } else { // Black
-        int minEval = 99999999;
-        for (auto &m : moves) {
-            int captured = board[m.toRow][m.toCol];
-            int movingPiece = board[m.fromRow][m.fromCol];
 
-            board[m.toRow][m.toCol] = movingPiece;
-            board[m.fromRow][m.fromCol] = 0;
+        makeMove(pos, m);
+        bool givesCheck = quiet ? quietCheck : isSquareAttacked(pos, kingSquare(pos, side ^ 1), side == WHITE);
+        if (canExtend && extension == 0) {
+            if (givesCheck) {
+                extension = 1;
+                info.checkExtensions++;
+            } else if (recapture) {
+                extension = 1;
+                info.recaptureExtensions++;
+            }
+        }
+        int newDepth = depth - 1 + extension;
+        plyState[ply + 1].extensions = plyState[ply].extensions + extension;
 
-            int eval = minimax(board, depth - 1, true, alpha, beta);
+        if (newDepth > 0) prefetchTT(pos.key);
+        int score;
+        if (i == 0) {
+            score = -negamax(t, newDepth, -beta, -alpha, ply + 1);
+        } else {
+            // Late move reductions: scout late quiet moves at reduced depth
+            // and only search them fully if they beat alpha after all
+            int reduction = 0;
+            if (lateQuiet && depth >= LMR_MIN_DEPTH && i >= LMR_MIN_MOVE) {
+                reduction = LMR_TABLE[std::min(depth, 63)][std::min(i, 63)] - (pvNode ? 1 : 0);
+                reduction = std::max(0, std::min(reduction, newDepth - 1));
+            }
+            score = -negamax(t, newDepth - reduction, -alpha - 1, -alpha, ply + 1);
+            if (reduction > 0 && score > alpha)
+                score = -negamax(t, newDepth, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+                score = -negamax(t, newDepth, -beta, -alpha, ply + 1);
+        }
+        unmakeMove(pos);
+        if (t.search->stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = m;
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) { // Pruning
+                info.cutoffs++;
+                if (i == 0) info.firstMoveCutoffs++;
+                if (quiet) updateQuietHeuristics(t.ordering, pos, m, depth, ply, quietsTried, quietCount);
+                break;
+            }
+        }
+        if (quiet && quietCount < 64) quietsTried[quietCount++] = m;
+    }
 
-            board[m.fromRow][m.fromCol] = movingPiece;
-            board[m.toRow][m.toCol] = captured;
+    // At or above beta the real score may be higher, at or below the
+    // original alpha it may be lower
+    int bound = BOUND_EXACT;
+    if (bestScore >= beta) bound = BOUND_LOWER;
+    else if (bestScore <= alphaOrig) bound = BOUND_UPPER;
+    if (excluded == NO_MOVE) storeTT(pos.key, bestMove, scoreToTT(bestScore, ply), depth, bound);
 
-            minEval = std::min(minEval, eval);
-            beta = std::min(beta, eval);
-            if (beta <= alpha) break; // Pruning
+    return bestScore;
+}
+
+// One iteration over the root moves, PVS as above. Each move's score (or
+// bound, when it failed low) is left in moves.scores for the next sort.
+int searchRoot(SearchThread& t, MoveList& moves, int depth, int alpha, int beta, Move& bestMove) {
+    Position& pos = t.pos;
+    int bestScore = -INFINITY_SCORE;
+    t.plyState[0] = PlyState{NO_MOVE, 0};
+    for (int i = 0; i < moves.size(); i++) {
+        makeMove(pos, moves[i]);
+        t.plyState[1].extensions = 0;
+        int score;
+        if (i == 0) {
+            score = -negamax(t, depth - 1, -beta, -alpha, 1);
+        } else {
+            score = -negamax(t, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta)
+                score = -negamax(t, depth - 1, -beta, -alpha, 1);
+        }
+        unmakeMove(pos);
+        if (t.search->stopped) return 0;
+
+        moves.scores[i] = score;
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = moves[i];
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) break;
         }
-        return minEval;
     }
+    return bestScore;
 }
 
-Move getBestMove(int board[8][8]) {
-    int bestScore = 99999999;
-    Move bestMove = {-1, -1, -1, -1, 0};
-    
-    std::vector<Move> moves = generateAllMoves(board, false);
-    
-    // NEW: Order moves at the root too
-    orderMoves(moves, board);
+// Thread 0's latest iteration with the node count of all threads so far
+void reportIteration(SearchThread& t) {
+    Search& s = *t.search;
+    SearchInfo progress = t.info;
+    progress.nodes = 0;
+    for (SearchThread* other : s.threads) progress.nodes += other->nodes.load(std::memory_order_relaxed);
+    progress.timeMs = elapsedMs(s);
+    progress.threads = (int)s.threads.size();
+    s.limits.onIteration(progress, t.bestMove);
+}
 
-    for (auto &m : moves) {
-        int captured = board[m.toRow][m.toCol];
-        int movingPiece = board[m.fromRow][m.fromCol];
+// Iterative deepening: search depth 1, 2, 3... until a limit is hit. Each
+// iteration sorts the root moves by the previous one's scores, so the best
+// move so far is searched first. An iteration cut short is discarded and
+// the move from the last completed depth is played.
+//
+// Aspiration windows: the score rarely moves much between iterations, so
+// each one starts with a narrow window around the last score. If the
+// result falls outside it, that side of the window is widened and the
+// depth is searched again.
+void iterativeDeepening(SearchThread& t) {
+    Search& s = *t.search;
+    Position& pos = t.pos;
+    MoveList moves;
+    generateAllMoves(pos, pos.whiteToMove, moves);
+    if (moves.empty()) return;
 
-        board[m.toRow][m.toCol] = movingPiece;
-        board[m.fromRow][m.fromCol] = 0;
+    TTEntry entry;
+    orderMoves(moves, pos, t.ordering, probeTT(pos.key, entry) ? entry.move : NO_MOVE);
+    t.bestMove = moves[0]; // Played if not even depth 1 completes
+    int previousScore = 0;
 
-        int score = minimax(board, 4, true, -99999999, 99999999);
+    // Odd helpers start a ply deeper, so half the threads work ahead
+    for (int depth = 1 + (t.id & 1); depth <= s.limits.maxDepth && depth < MAX_PLY; depth++) {
+        int window = ASPIRATION_WINDOW;
+        int alpha = -INFINITY_SCORE, beta = INFINITY_SCORE;
+        if (depth >= ASPIRATION_MIN_DEPTH && abs(previousScore) < MATE_BOUND) {
+            alpha = std::max(previousScore - window, -INFINITY_SCORE);
+            beta = std::min(previousScore + window, INFINITY_SCORE);
+        }
 
-        board[m.fromRow][m.fromCol] = movingPiece;
-        board[m.toRow][m.toCol] = captured;
+        int score;
+        Move iterationMove = NO_MOVE;
+        while (true) {
+            score = searchRoot(t, moves, depth, alpha, beta, iterationMove);
+            if (t.search->stopped) break;
 
-        if (score < bestScore) {
-            bestScore = score;
-            bestMove = m;
+            if (score <= alpha && alpha > -INFINITY_SCORE) {
+                alpha = std::max(score - window, -INFINITY_SCORE);
+            } else if (score >= beta && beta < INFINITY_SCORE) {
+                beta = std::min(score + window, INFINITY_SCORE);
+            } else {
+                break;
+            }
+            window *= 2;
+            sortMoves(moves);
         }
+        if (t.search->stopped) break;
+
+        t.bestMove = iterationMove;
+        previousScore = score;
+        t.info.depth = depth;
+        t.info.score = score;
+        storeTT(pos.key, t.bestMove, scoreToTT(score, 0), depth, BOUND_EXACT);
+        sortMoves(moves);
+        if (t.id == 0 && s.limits.onIteration) reportIteration(t);
+
+        // Nothing more to learn once a forced mate is found. Only thread 0
+        // decides on time: with no choice, or past half the budget (the next
+        // iteration would not finish anyway), the search is over.
+        if (abs(score) >= MATE_BOUND) break;
+        if (t.id == 0 && moves.size() == 1) break;
+        if (t.id == 0 && timeLimited(s) && elapsedMs(s) * 2 >= s.limits.timeMs) break;
     }
-    return bestMove;
-}
\ No newline at end of file
+}
+
+// seen is the generation at creation, so a pool rebuilt after earlier
+// searches does not take the last one for a new search
+void helperLoop(SearchThread* t, int seen) {
+    Search& s = *t->search;
+    std::unique_lock<std::mutex> lock(s.poolMutex);
+    while (true) {
+        s.poolWake.wait(lock, [&] { return s.poolQuit || s.poolGeneration != seen; });
+        if (s.poolQuit) return;
+        seen = s.poolGeneration;
+
+        lock.unlock();
+        iterativeDeepening(*t);
+        lock.lock();
+        if (--s.helpersRunning == 0) s.poolDone.notify_all();
+    }
+}
+
+// Joins the helpers and frees the threads
+void stopSearchThreads(Search& s) {
+    {
+        std::lock_guard<std::mutex> lock(s.poolMutex);
+        s.poolQuit = true;
+    }
+    s.poolWake.notify_all();
+    for (std::thread& helper : s.helpers) helper.join();
+    s.helpers.clear();
+    for (SearchThread* t : s.threads) delete t;
+    s.threads.clear();
+    s.poolQuit = false;
+}
+
+// Destroying a std::thread that is still running aborts the program, so
+// the helpers are joined first; for defaultSearch that happens at exit.
+Search::~Search() {
+    stopSearchThreads(*this);
+}
+
+// Number of search threads; 0 or less means one per hardware thread.
+// Must not be called while a search is running.
+void setSearchThreads(Search& s, int count) {
+    if (count <= 0) count = std::max(1, (int)std::thread::hardware_concurrency());
+
+    stopSearchThreads(s);
+    for (int i = 0; i < count; i++) {
+        s.threads.push_back(new SearchThread());
+        s.threads[i]->search = &s;
+        s.threads[i]->id = i;
+        if (i > 0) s.helpers.emplace_back(helperLoop, s.threads[i], s.poolGeneration);
+    }
+}
+
+void setSearchThreads(int count) {
+    setSearchThreads(defaultSearch, count);
+}
+
+// Searches pos under limits with the threads of s. The result's counters
+// are left in s.info.
+Move searchPosition(Search& s, Position& pos, const SearchLimits& limits) {
+    if (s.threads.empty()) setSearchThreads(s, 0);
+    initLMR();
+
+    s.limits = limits;
+    s.start = SearchClock::now();
+    s.stopped = false;
+    if (s.agesTT) ttNewSearch();
+
+    for (SearchThread* t : s.threads) {
+        t->pos = pos;
+        // Only the last move played matters to the search, so each thread
+        // starts with that one entry and all of the stack for its own plies
+        if (pos.historyCount > 1) {
+            t->pos.history[0] = pos.history[pos.historyCount - 1];
+            t->pos.historyCount = 1;
+        }
+        t->nodes = 0;
+        t->info = SearchInfo();
+        t->bestMove = NO_MOVE;
+        resetQuietHeuristics(t->ordering);
+        if (t->id > 0) addHistoryNoise(t->ordering, t->id);
+    }
+
+    // Wake the helpers, search on this thread, then stop them
+    {
+        std::lock_guard<std::mutex> lock(s.poolMutex);
+        s.helpersRunning = (int)s.threads.size() - 1;
+        s.poolGeneration++;
+    }
+    s.poolWake.notify_all();
+    iterativeDeepening(*s.threads[0]);
+    s.stopped = true;
+    {
+        std::unique_lock<std::mutex> lock(s.poolMutex);
+        s.poolDone.wait(lock, [&] { return s.helpersRunning == 0; });
+    }
+
+    // Play the move from the deepest completed iteration; ties go to thread 0
+    SearchThread* best = s.threads[0];
+    for (SearchThread* t : s.threads) {
+        if (t->bestMove != NO_MOVE && t->info.depth > best->info.depth) best = t;
+    }
+
+    SearchInfo result;
+    for (SearchThread* t : s.threads) {
+        t->info.nodes = t->nodes;
+        result.addCounters(t->info);
+    }
+    result.depth = best->info.depth;
+    result.score = best->info.score;
+    result.timeMs = elapsedMs(s);
+    result.threads = (int)s.threads.size();
+    s.info = result;
+    return best->bestMove;
+}
+
+Move getBestMove(Position& pos, const SearchLimits& limits) {
+#ifdef COUNT_ALLOCATIONS
+    if (defaultSearch.threads.empty()) setSearchThreads(0);
+    long long allocationsBefore = heapAllocations;
+#endif
+
+    Move best = searchPosition(defaultSearch, pos, limits);
+    searchInfo = defaultSearch.info;
+
+#ifdef COUNT_ALLOCATIONS
+    std::cout << "Search heap allocations: " << heapAllocations - allocationsBefore << std::endl;
+#endif
+    return best;
+}
+
+// Rebuilds the principal variation from the hash moves, starting with
+// best. Stops at a missing or illegal hash move, or when a position repeats.
+// pos is left as it was.
+int principalVariation(Position& pos, Move best, Move* pv, int maxLength) {
+    uint64_t seen[MAX_PLY];
+    int length = 0;
+    Move m = best;
+    while (m != NO_MOVE && length < maxLength && length < MAX_PLY) {
+        MoveList legal;
+        generateAllMoves(pos, pos.whiteToMove, legal);
+        bool isLegal = false;
+        for (Move l : legal) if (l == m) isLegal = true;
+        if (!isLegal) break;
+
+        seen[length] = pos.key;
+        makeMove(pos, m);
+        pv[length++] = m;
+
+        bool repeated = false;
+        for (int i = 0; i < length; i++) if (seen[i] == pos.key) repeated = true;
+        if (repeated) break;
+
+        TTEntry entry;
+        m = probeTT(pos.key, entry) ? entry.move : NO_MOVE;
+    }
+    for (int i = 0; i < length; i++) unmakeMove(pos);
+    return length;
+}
+
+// A score as UCI prints it: "cp 31" or, for a forced mate, "mate 3" /
+// "mate -2" in moves
+std::string uciScore(int score) {
+    if (score >= MATE_BOUND) return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    if (score <= -MATE_BOUND) return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+    return "cp " + std::to_string(score);
+}
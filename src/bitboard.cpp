@@ -0,0 +1,193 @@
+#include <cstdint>
+
+// ──────────────────────────────────────────────
+// BITBOARD BASICS
+// ──────────────────────────────────────────────
+// One bit per square. Square index = row * 8 + col, using the same layout
+// as board[8][8]: square 0 is a8 (row 0, col 0) and square 63 is h1.
+typedef uint64_t Bitboard;
+
+// Colors index the per-side bitboards
+const int WHITE = 0;
+const int BLACK = 1;
+
+// Piece types use the same codes as board[8][8]
+const int ROOK = 1, KNIGHT = 2, BISHOP = 3, QUEEN = 4, KING = 5, PAWN = 6;
+
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard ROW_0_BB = 0xFFULL; // Rank 8
+
+inline Bitboard rowBB(int row) { return ROW_0_BB << (8 * row); }
+inline Bitboard fileBB(int col) { return FILE_A_BB << col; }
+
+inline int squareOf(int row, int col) { return row * 8 + col; }
+inline int rowOf(int sq) { return sq >> 3; }
+inline int colOf(int sq) { return sq & 7; }
+inline Bitboard squareBB(int sq) { return 1ULL << sq; }
+
+inline int popCount(Bitboard b) { return __builtin_popcountll(b); }
+inline int bitScan(Bitboard b) { return __builtin_ctzll(b); }
+
+// Returns the lowest set square and clears it from the bitboard
+inline int popLsb(Bitboard &b) {
+    int sq = __builtin_ctzll(b);
+    b &= b - 1;
+    return sq;
+}
+
+// ──────────────────────────────────────────────
+// PRECOMPUTED ATTACK TABLES
+// ──────────────────────────────────────────────
+Bitboard KNIGHT_ATTACKS[64];
+Bitboard KING_ATTACKS[64];
+Bitboard PAWN_ATTACKS[2][64]; // [color][sq]: squares a pawn on sq attacks
+Bitboard BETWEEN[64][64];     // Squares strictly between two aligned squares
+Bitboard LINE[64][64];        // Whole rank/file/diagonal through two aligned squares
+
+// Fancy magic lookup: index = ((occupied & mask) * magic) >> shift
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    int shift;
+};
+
+Magic ROOK_MAGICS[64];
+Magic BISHOP_MAGICS[64];
+Bitboard ROOK_TABLE[0x19000];  // Sum of 2^bits over all rook masks
+Bitboard BISHOP_TABLE[0x1480]; // Sum of 2^bits over all bishop masks
+
+const int ROOK_DIRS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+const int BISHOP_DIRS[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied) {
+    const Magic &m = ROOK_MAGICS[sq];
+    return m.attacks[((occupied & m.mask) * m.magic) >> m.shift];
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occupied) {
+    const Magic &m = BISHOP_MAGICS[sq];
+    return m.attacks[((occupied & m.mask) * m.magic) >> m.shift];
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied) {
+    return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied);
+}
+
+// Slow ray walk, only used to fill the magic tables at startup
+Bitboard slidingAttacks(int sq, Bitboard occupied, const int dirs[4][2]) {
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        for (int i = 1; i < 8; i++) {
+            int r = rowOf(sq) + dirs[d][0] * i;
+            int c = colOf(sq) + dirs[d][1] * i;
+            if (r < 0 || r >= 8 || c < 0 || c >= 8) break;
+            attacks |= squareBB(squareOf(r, c));
+            if (occupied & squareBB(squareOf(r, c))) break; // Blocked
+        }
+    }
+    return attacks;
+}
+
+Bitboard stepAttacks(int sq, const int steps[][2], int count) {
+    Bitboard attacks = 0;
+    for (int i = 0; i < count; i++) {
+        int r = rowOf(sq) + steps[i][0];
+        int c = colOf(sq) + steps[i][1];
+        if (r >= 0 && r < 8 && c >= 0 && c < 8) attacks |= squareBB(squareOf(r, c));
+    }
+    return attacks;
+}
+
+// xorshift64* - deterministic so every run finds the same magics
+uint64_t magicRandom() {
+    static uint64_t seed = 1070372ULL;
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+    return seed * 2685821657736338717ULL;
+}
+
+void initMagics(Magic magics[64], Bitboard* table, const int dirs[4][2]) {
+    Bitboard occupancy[4096], reference[4096];
+    int epoch[4096] = {0};
+    int attempt = 0;
+
+    for (int sq = 0; sq < 64; sq++) {
+        Magic &m = magics[sq];
+
+        // Board edges never block a ray, unless the slider is standing on them
+        Bitboard edges = ((rowBB(0) | rowBB(7)) & ~rowBB(rowOf(sq))) |
+                         ((FILE_A_BB | FILE_H_BB) & ~fileBB(colOf(sq)));
+        m.mask = slidingAttacks(sq, 0, dirs) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = table;
+
+        // Carry-Rippler: enumerate every subset of the mask
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(sq, b, dirs);
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+        // Try sparse random numbers until one maps all subsets without collisions
+        for (int i = 0; i < size;) {
+            do {
+                m.magic = magicRandom() & magicRandom() & magicRandom();
+            } while (popCount((m.mask * m.magic) >> 56) < 6);
+
+            attempt++;
+            for (i = 0; i < size; i++) {
+                unsigned idx = (unsigned)((occupancy[i] * m.magic) >> m.shift);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) {
+                    break; // Destructive collision, try another magic
+                }
+            }
+        }
+        table += size;
+    }
+}
+
+void initBitboards() {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+
+    const int knightSteps[8][2] = {{2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}};
+    const int kingSteps[8][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    const int whitePawnSteps[2][2] = {{-1, -1}, {-1, 1}}; // White moves up (row - 1)
+    const int blackPawnSteps[2][2] = {{1, -1}, {1, 1}};
+
+    for (int sq = 0; sq < 64; sq++) {
+        KNIGHT_ATTACKS[sq] = stepAttacks(sq, knightSteps, 8);
+        KING_ATTACKS[sq] = stepAttacks(sq, kingSteps, 8);
+        PAWN_ATTACKS[WHITE][sq] = stepAttacks(sq, whitePawnSteps, 2);
+        PAWN_ATTACKS[BLACK][sq] = stepAttacks(sq, blackPawnSteps, 2);
+    }
+
+    initMagics(ROOK_MAGICS, ROOK_TABLE, ROOK_DIRS);
+    initMagics(BISHOP_MAGICS, BISHOP_TABLE, BISHOP_DIRS);
+
+    // Pin rays and check-blocking squares
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            BETWEEN[a][b] = LINE[a][b] = 0;
+            if (a == b) continue;
+            Bitboard ends = squareBB(a) | squareBB(b);
+            if (rookAttacks(a, 0) & squareBB(b)) {
+                LINE[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | ends;
+                BETWEEN[a][b] = rookAttacks(a, squareBB(b)) & rookAttacks(b, squareBB(a));
+            } else if (bishopAttacks(a, 0) & squareBB(b)) {
+                LINE[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | ends;
+                BETWEEN[a][b] = bishopAttacks(a, squareBB(b)) & bishopAttacks(b, squareBB(a));
+            }
+        }
+    }
+}
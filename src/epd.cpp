@@ -0,0 +1,397 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "bitboard.cpp"
+#include "zobrist.cpp"
+#include "position.cpp"
+#include "move.cpp"
+#include "tt.cpp"
+#include "ai.cpp"
+
+// ──────────────────────────────
+// Input file
+// ──────────────────────────────
+// The file is mapped rather than read, so a batch of any size costs no
+// copy and the workers read their lines straight from the page cache.
+// Windows (MinGW) builds read it into memory instead.
+struct InputFile {
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::string contents;
+#else
+    void* mapping = nullptr;
+#endif
+};
+
+bool openInput(InputFile &file, const char* path) {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    file.contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    file.data = file.contents.data();
+    file.size = file.contents.size();
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+    file.size = (size_t)st.st_size;
+    if (file.size > 0) {
+        file.mapping = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (file.mapping == MAP_FAILED) { close(fd); file.mapping = nullptr; return false; }
+        file.data = (const char*)file.mapping;
+    }
+    close(fd); // The mapping stays valid
+    return true;
+#endif
+}
+
+void closeInput(InputFile &file) {
+#ifndef _WIN32
+    if (file.mapping) munmap(file.mapping, file.size);
+    file.mapping = nullptr;
+#endif
+    file.data = nullptr;
+    file.size = 0;
+}
+
+struct Line {
+    const char* begin;
+    size_t length;
+};
+
+// Every line holding a position: blank lines and # comments are skipped
+std::vector<Line> splitLines(const InputFile &file) {
+    std::vector<Line> lines;
+    size_t start = 0;
+    for (size_t i = 0; i <= file.size; i++) {
+        if (i < file.size && file.data[i] != '\n') continue;
+        size_t end = i;
+        while (end > start && (file.data[end - 1] == '\r' || file.data[end - 1] == ' ')) end--;
+        size_t first = start;
+        while (first < end && (file.data[first] == ' ' || file.data[first] == '\t')) first++;
+        if (first < end && file.data[first] != '#') lines.push_back({file.data + first, end - first});
+        start = i + 1;
+    }
+    return lines;
+}
+
+// ──────────────────────────────
+// EPD records
+// ──────────────────────────────
+// An EPD line is the first four FEN fields followed by operations such as
+// bm Nf3; id "WAC.001"; - a plain FEN line (with move clocks) also works.
+struct EpdRecord {
+    std::string fen;
+    std::string operations;
+};
+
+bool isNumber(const std::string &s) {
+    if (s.empty()) return false;
+    for (char c : s) if (c < '0' || c > '9') return false;
+    return true;
+}
+
+EpdRecord parseEpd(const std::string &line) {
+    std::istringstream in(line);
+    std::vector<std::string> fields;
+    std::string field;
+    while (fields.size() < 6 && in >> field) fields.push_back(field);
+
+    // Fields 5 and 6 are FEN move clocks only if both are numbers
+    size_t fenFields = std::min<size_t>(4, fields.size());
+    if (fields.size() == 6 && isNumber(fields[4]) && isNumber(fields[5])) fenFields = 6;
+
+    EpdRecord record;
+    for (size_t i = 0; i < fenFields; i++) record.fen += (i ? " " : "") + fields[i];
+    for (size_t i = fenFields; i < fields.size(); i++) record.operations += fields[i] + " ";
+    std::string rest;
+    std::getline(in, rest);
+    record.operations += rest;
+    return record;
+}
+
+// Value of one operation, e.g. "Nf3 Qxd5" for bm or "WAC.001" for id,
+// without quotes. Empty if the record does not have it.
+std::string epdOperation(const EpdRecord &record, const std::string &opcode) {
+    const std::string &ops = record.operations;
+    size_t pos = 0;
+    while (pos < ops.size()) {
+        size_t end = ops.find(';', pos);
+        if (end == std::string::npos) end = ops.size();
+        std::istringstream op(ops.substr(pos, end - pos));
+        std::string code, value, word;
+        op >> code;
+        if (code == opcode) {
+            while (op >> word) value += (value.empty() ? "" : " ") + word;
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') value = value.substr(1, value.size() - 2);
+            return value;
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+// ──────────────────────────────
+// Batch runner
+// ──────────────────────────────
+// Each worker owns a single-threaded Search and its own Position, and
+// takes the next unclaimed line from a shared atomic cursor, so workers
+// never wait on each other. The transposition table is the only thing
+// they share. Results are printed by the main thread in input order as
+// soon as every earlier line is done.
+struct BatchResults {
+    std::vector<std::string> lines;
+    std::vector<char> ready;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::atomic<long long> nodes{0};
+
+    // Test suites only
+    std::atomic<int> solved{0};
+    std::atomic<long long> solveMs{0};
+    std::atomic<long long> solveNodes{0};
+};
+
+// Turns one input line into one output line
+typedef std::string (*BatchJob)(Search &search, const Line &line, const SearchLimits &limits, BatchResults &results);
+
+void batchWorker(const std::vector<Line> &lines, std::atomic<size_t> &cursor, SearchLimits limits,
+                 BatchJob job, BatchResults &results) {
+    Search search;
+    search.agesTT = false;
+    setSearchThreads(search, 1);
+
+    while (true) {
+        size_t i = cursor.fetch_add(1, std::memory_order_relaxed);
+        if (i >= lines.size()) break;
+        std::string result = job(search, lines[i], limits, results);
+        {
+            std::lock_guard<std::mutex> lock(results.mutex);
+            results.lines[i] = std::move(result);
+            results.ready[i] = 1;
+        }
+        results.done.notify_one();
+    }
+}
+
+// Runs job over every line on threads workers. Returns the wall time in seconds.
+double runBatch(const std::vector<Line> &lines, const SearchLimits &limits, int threads, BatchJob job,
+                BatchResults &results) {
+    results.lines.resize(lines.size());
+    results.ready.assign(lines.size(), 0);
+    std::atomic<size_t> cursor{0};
+
+    initLMR();
+    ttNewSearch(); // One table age for the whole batch
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(batchWorker, std::cref(lines), std::ref(cursor), limits, job, std::ref(results));
+
+    for (size_t next = 0; next < lines.size(); next++) {
+        std::unique_lock<std::mutex> lock(results.mutex);
+        results.done.wait(lock, [&] { return results.ready[next] != 0; });
+        std::string line = std::move(results.lines[next]);
+        lock.unlock();
+        std::cout << line << std::endl;
+    }
+    for (std::thread &w : workers) w.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ──────────────────────────────
+// Batch analysis
+// ──────────────────────────────
+std::string analyzeLine(Search &search, const Line &line, const SearchLimits &limits, BatchResults &results) {
+    EpdRecord record = parseEpd(std::string(line.begin, line.length));
+    std::string id = epdOperation(record, "id");
+    std::string prefix = id.empty() ? "" : id + " ";
+
+    Position pos;
+    if (!setPositionFromFen(pos, record.fen)) return prefix + "invalid fen " + record.fen;
+
+    Move best = searchPosition(search, pos, limits);
+    const SearchInfo &info = search.info;
+    results.nodes += info.nodes;
+    return prefix + "bestmove " + (best == NO_MOVE ? "0000" : moveToString(best)) +
+           " score " + uciScore(info.score) + " depth " + std::to_string(info.depth) +
+           " nodes " + std::to_string(info.nodes) + " time " + std::to_string(info.timeMs);
+}
+
+int runAnalysis(const std::vector<Line> &lines, const SearchLimits &limits, int threads) {
+    BatchResults results;
+    double seconds = runBatch(lines, limits, threads, analyzeLine, results);
+
+    // Summary on stderr, so stdout stays one line per position
+    std::cerr << "Positions: " << lines.size() << "  Nodes: " << results.nodes << "  Time: " << std::fixed
+              << std::setprecision(2) << seconds << "s  NPS: "
+              << (long long)(results.nodes / (seconds > 0 ? seconds : 1e-9)) << std::endl;
+    return 0;
+}
+
+// ──────────────────────────────
+// Test suites (bm / am)
+// ──────────────────────────────
+// A position is solved when the search ends on a bm move (or on anything
+// but the am moves). Time to solution is when that answer first came out
+// of an iteration and stayed there until the end: a move found early and
+// then dropped does not count. The workers share the transposition table,
+// so a suite that repeats a position solves the repeat faster; use
+// -threads 1 and -hash sized for one position when that matters.
+struct SolveTracker {
+    const Position* pos;
+    const EpdRecord* record;
+    bool solving;     // Best move of the latest iteration solves it
+    int solvedMs;     // ...since this time and node count
+    long long solvedNodes;
+};
+
+// The iteration callback runs on the worker's own thread (its Search has
+// no helpers), so each worker keeps its tracker here.
+thread_local SolveTracker solveTracker;
+
+// SAN in the file and ours may differ in +, #, ! and ? marks
+std::string stripAnnotations(std::string san) {
+    while (!san.empty() && std::string("+#!?").find(san.back()) != std::string::npos) san.pop_back();
+    return san;
+}
+
+bool listsMove(const std::string &moves, const Position &pos, Move m) {
+    std::istringstream in(moves);
+    std::string san = moveToSan(pos, m), word;
+    while (in >> word) {
+        word = stripAnnotations(word);
+        if (word == san || word == moveToString(m)) return true;
+    }
+    return false;
+}
+
+bool solves(const EpdRecord &record, const Position &pos, Move m) {
+    if (m == NO_MOVE) return false;
+    std::string bm = epdOperation(record, "bm"), am = epdOperation(record, "am");
+    if (!bm.empty() && !listsMove(bm, pos, m)) return false;
+    if (!am.empty() && listsMove(am, pos, m)) return false;
+    return true;
+}
+
+void trackIteration(const SearchInfo &progress, Move best) {
+    SolveTracker &t = solveTracker;
+    bool ok = solves(*t.record, *t.pos, best);
+    if (ok && !t.solving) {
+        t.solvedMs = progress.timeMs;
+        t.solvedNodes = progress.nodes;
+    }
+    t.solving = ok;
+}
+
+std::string solveLine(Search &search, const Line &line, const SearchLimits &limits, BatchResults &results) {
+    EpdRecord record = parseEpd(std::string(line.begin, line.length));
+    std::string id = epdOperation(record, "id");
+    std::string bm = epdOperation(record, "bm"), am = epdOperation(record, "am");
+    std::string expected = !bm.empty() ? "bm " + bm : "am " + am;
+    if (id.empty()) id = record.fen;
+
+    Position pos;
+    if (!setPositionFromFen(pos, record.fen)) return "  FAIL   " + id + ": invalid fen";
+    if (bm.empty() && am.empty()) return "  FAIL   " + id + ": no bm or am";
+
+    solveTracker = SolveTracker{&pos, &record, false, 0, 0};
+    SearchLimits trackedLimits = limits;
+    trackedLimits.onIteration = trackIteration;
+    Move best = searchPosition(search, pos, trackedLimits);
+    results.nodes += search.info.nodes;
+
+    std::string found = (best == NO_MOVE) ? "none" : moveToSan(pos, best);
+    bool ok = solveTracker.solving && solves(record, pos, best);
+    if (!ok) return "  FAIL   " + id + ": played " + found + ", expected " + expected;
+
+    results.solved++;
+    results.solveMs += solveTracker.solvedMs;
+    results.solveNodes += solveTracker.solvedNodes;
+    return "  ok     " + id + ": " + found + " after " + std::to_string(solveTracker.solvedMs) + " ms, " +
+           std::to_string(solveTracker.solvedNodes) + " nodes";
+}
+
+// Returns the number of positions not solved
+int runTestSuite(const std::vector<Line> &lines, const SearchLimits &limits, int threads) {
+    BatchResults results;
+    double seconds = runBatch(lines, limits, threads, solveLine, results);
+
+    int solved = results.solved;
+    std::cout << std::endl << "Solved: " << solved << "/" << lines.size() << std::endl;
+    if (solved) {
+        std::cout << "Time to solution: " << results.solveMs << " ms total, " << results.solveMs / solved
+                  << " ms average" << std::endl
+                  << "Nodes to solution: " << results.solveNodes << " total, " << results.solveNodes / solved
+                  << " average" << std::endl;
+    }
+    std::cout << "Nodes: " << results.nodes << "  Time: " << std::fixed << std::setprecision(2) << seconds
+              << "s  NPS: " << (long long)(results.nodes / (seconds > 0 ? seconds : 1e-9)) << std::endl;
+    return (int)lines.size() - solved;
+}
+
+// ──────────────────────────────
+// Entry point
+// ──────────────────────────────
+//   epd [options] analyze <file>   best move, score, depth, nodes and time per position
+//   epd [options] suite <file>     bm/am test suite: solved count and time to solution
+// options: -threads N (default: all cores), -hash MB (default 64),
+//          -movetime MS (default 1000), -depth N, -nodes N
+int main(int argc, char* argv[]) {
+    initBitboards();
+    initZobrist();
+
+    int threads = (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    int hashMB = 64;
+    SearchLimits limits;
+    limits.timeMs = 1000;
+
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-hash" && i + 1 < argc) hashMB = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-movetime" && i + 1 < argc) limits.timeMs = std::atoi(argv[++i]);
+        else if (a == "-depth" && i + 1 < argc) { limits.maxDepth = std::atoi(argv[++i]); limits.timeMs = 0; }
+        else if (a == "-nodes" && i + 1 < argc) { limits.nodes = std::atoll(argv[++i]); limits.timeMs = 0; }
+        else args.push_back(a);
+    }
+
+    if (args.size() < 2 || (args[0] != "analyze" && args[0] != "suite")) {
+        std::cout << "usage: epd [-threads N] [-hash MB] [-movetime MS | -depth N | -nodes N] analyze <file>" << std::endl
+                  << "       epd [-threads N] [-hash MB] [-movetime MS | -depth N | -nodes N] suite <file>" << std::endl;
+        return 1;
+    }
+
+    InputFile file;
+    if (!openInput(file, args[1].c_str())) {
+        std::cout << "Cannot open " << args[1] << std::endl;
+        return 1;
+    }
+    initTT(hashMB);
+    std::vector<Line> lines = splitLines(file);
+    int status = (args[0] == "suite") ? (runTestSuite(lines, limits, threads) ? 1 : 0)
+                                      : runAnalysis(lines, limits, threads);
+    closeInput(file);
+    return status;
+}
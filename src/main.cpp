@@ -2,7 +2,13 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <thread>
+#include <atomic>
+#include "bitboard.cpp"
+#include "zobrist.cpp"
+#include "position.cpp"
 #include "move.cpp" 
+#include "tt.cpp"
 #include "ai.cpp"   
 
 // ──────────────────────────────
@@ -17,18 +23,15 @@ const int PIECE_HEIGHT = 150;
 // GLOBAL VARIABLES
 // ──────────────────────────────
 bool whiteTurn = true;
-bool WhiteKingMoved = false, BlackKingMoved = false;
-bool WhiteKingsideRookMoved = false, WhiteQueensideRookMoved = false;
-bool BlackKingsideRookMoved = false, BlackQueensideRookMoved = false;
 
 bool isDragging = false;
 int selectedPiece = -1;
 int startCol, startRow;
 SDL_Point mouseOffset;
-std::vector<std::pair<int, int>> legalMoves;
+MoveList legalMoves;
 
 // UI GLOBALS
-Move lastMove = {-1, -1, -1, -1}; // Tracks last move for highlighting
+Move lastMove = NO_MOVE; // Tracks last move for highlighting
 bool isGameOver = false;
 std::string gameOverMsg = "";
 
@@ -36,6 +39,9 @@ std::string gameOverMsg = "";
 bool aiHasMoved = false;
 Uint32 lastAITime = 0;
 const Uint32 AI_DELAY = 100; 
+const int TT_SIZE_MB = 64; // Transposition table size
+const int AI_TIME_MS = 1000; // Thinking time per AI move
+const int AI_THREADS = 0;    // Search threads, 0 = one per core
 
 // BOARD STATE
 int board[8][8] = {
@@ -49,6 +55,83 @@ int board[8][8] = {
     { 1,  2,  3,  4,  5,  3,  2,  1}  
 };
 
+// Rules state (castling rights, en passant, undo history). board[8][8]
+// mirrors it for rendering and mouse picking.
+Position game;
+
+void syncBoard() {
+    for (int sq = 0; sq < 64; sq++) board[rowOf(sq)][colOf(sq)] = game.squares[sq];
+}
+
+// Starts the game from a FEN instead of the initial board
+bool loadFen(const std::string& fen) {
+    if (!setPositionFromFen(game, fen)) return false;
+    syncBoard();
+    whiteTurn = game.whiteToMove;
+    return true;
+}
+
+// ──────────────────────────────
+// AI WORKER
+// ──────────────────────────────
+// The search runs on its own thread against a copy of the game, so the
+// window keeps drawing and handling events while the AI thinks. The main
+// loop polls aiDone and plays aiResult once it is set.
+//
+// During the human's turn the worker ponders: it searches the position
+// after the reply the AI expects. If the human plays that move the search
+// simply carries on as the real one, with the time already spent counted;
+// otherwise it is cancelled, and only its transposition table entries remain.
+std::thread aiWorker;
+Position aiPosition;
+Move aiResult = NO_MOVE;
+Move ponderMove = NO_MOVE;
+bool aiThinking = false;              // Only touched by the main loop
+std::atomic<bool> aiDone{false};      // Set by the worker when aiResult is ready
+std::atomic<bool> aiCancel{false};    // Set by the main loop to cut the search short
+std::atomic<bool> aiPondering{false}; // Cleared on a ponder hit, which puts the time budget in force
+
+// Searches aiPosition, which the caller has set up
+void startAISearch(bool ponder) {
+    aiDone = false;
+    aiCancel = false;
+    aiPondering = ponder;
+    aiThinking = true;
+    aiWorker = std::thread([] {
+        SearchLimits limits;
+        limits.timeMs = AI_TIME_MS;
+        limits.stop = &aiCancel;
+        limits.ponder = &aiPondering;
+        aiResult = getBestMove(aiPosition, limits);
+        aiDone.store(true, std::memory_order_release);
+    });
+}
+
+// The expected reply is the hash move of the position the AI just left
+void startPondering() {
+    TTEntry entry;
+    ponderMove = NO_MOVE;
+    if (!probeTT(game.key, entry)) return;
+
+    // A 16-bit key match can be a collision, so only trust a legal move
+    MoveList moves;
+    generateAllMoves(game, game.whiteToMove, moves);
+    for (const auto &m : moves) if (m == entry.move) ponderMove = m;
+    if (ponderMove == NO_MOVE) return;
+
+    aiPosition = game;
+    makeMove(aiPosition, ponderMove);
+    startAISearch(true);
+}
+
+// A ponder miss or closing the window: stop the search and wait for the worker
+void cancelAISearch() {
+    if (!aiWorker.joinable()) return;
+    aiCancel = true;
+    aiWorker.join();
+    aiThinking = false;
+}
+
 // ──────────────────────────────
 // HELPERS 
 // ──────────────────────────────
@@ -70,16 +153,11 @@ char pieceToSymbol(int piece) {
 // UI FEATURES
 // ──────────────────────────────
 void checkGameOver(bool isWhiteTurn) {
-    std::vector<Move> moves = generateAllMoves(board, isWhiteTurn);
+    MoveList moves;
+    generateAllMoves(game, isWhiteTurn, moves);
     if (moves.empty()) {
-        int kingVal = isWhiteTurn ? 5 : -5;
-        int kingRow = -1, kingCol = -1;
-        for(int r=0; r<8; r++) {
-            for(int c=0; c<8; c++) {
-                if(board[r][c] == kingVal) { kingRow=r; kingCol=c; }
-            }
-        }
-        bool inCheck = isSquareAttacked(kingRow, kingCol, !isWhiteTurn, board);
+        int kingSq = kingSquare(game, isWhiteTurn ? WHITE : BLACK);
+        bool inCheck = isSquareAttacked(game, kingSq, !isWhiteTurn);
         isGameOver = true;
         gameOverMsg = inCheck ? (isWhiteTurn ? "Checkmate! Black Wins." : "Checkmate! White Wins.") : "Stalemate! Draw.";
     }
@@ -89,10 +167,11 @@ void renderHighlights(SDL_Renderer* renderer) {
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     
     // Yellow Highlight for Last Move
-    if (lastMove.fromRow != -1) {
+    if (lastMove != NO_MOVE) {
+        int from = moveFrom(lastMove), to = moveTo(lastMove);
         SDL_SetRenderDrawColor(renderer, 255, 255, 0, 100); 
-        SDL_Rect src = {lastMove.fromCol * SQUARE_SIZE, lastMove.fromRow * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE};
-        SDL_Rect dst = {lastMove.toCol * SQUARE_SIZE, lastMove.toRow * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE};
+        SDL_Rect src = {colOf(from) * SQUARE_SIZE, rowOf(from) * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE};
+        SDL_Rect dst = {colOf(to) * SQUARE_SIZE, rowOf(to) * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE};
         SDL_RenderFillRect(renderer, &src);
         SDL_RenderFillRect(renderer, &dst);
     }
@@ -140,6 +219,11 @@ void renderPieces(SDL_Renderer* renderer, SDL_Texture* piecesTexture) {
 
 
 void handleEvents(SDL_Event &e) {
+    // F prints the current position, to reload later with main.exe "<fen>"
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_f) {
+        std::cout << "FEN: " << positionToFen(game) << std::endl;
+    }
+
     if (e.type == SDL_MOUSEBUTTONDOWN) {
         if (!whiteTurn) return;
         int col = e.button.x / SQUARE_SIZE;
@@ -150,7 +234,7 @@ void handleEvents(SDL_Event &e) {
             isDragging = true;
             selectedPiece = board[row][col];
             startCol = col; startRow = row;
-            legalMoves = getLegalMoves(row, col, board);
+            getLegalMoves(game, row, col, legalMoves);
             mouseOffset.x = e.button.x - (col * SQUARE_SIZE);
             mouseOffset.y = e.button.y - (row * SQUARE_SIZE);
         }
@@ -159,34 +243,31 @@ void handleEvents(SDL_Event &e) {
     if (e.type == SDL_MOUSEBUTTONUP && isDragging) {
         int col = e.button.x / SQUARE_SIZE;
         int row = e.button.y / SQUARE_SIZE;
-        bool isLegal = false;
-        for (const auto &m : legalMoves) if (m.first == row && m.second == col) isLegal = true;
-
-        if (isLegal) {
-            // CASTLING & FLAGS
-            if(abs(selectedPiece) == 5) { if(selectedPiece>0) WhiteKingMoved=true; else BlackKingMoved=true; }
-            if(abs(selectedPiece) == 1) {
-                if(startRow==7 && startCol==0) WhiteQueensideRookMoved=true;
-                if(startRow==7 && startCol==7) WhiteKingsideRookMoved=true;
-                if(startRow==0 && startCol==0) BlackQueensideRookMoved=true;
-                if(startRow==0 && startCol==7) BlackKingsideRookMoved=true;
-            }
-            // Move Rook for Castling
-            if (abs(selectedPiece)==5 && abs(col-startCol)==2) {
-                if (col==6) { board[row][5] = board[row][7]; board[row][7]=0; } // KingSide
-                if (col==2) { board[row][3] = board[row][0]; board[row][0]=0; } // QueenSide
-            }
-
-            // EXECUTE MOVE
-            board[row][col] = selectedPiece;
-            board[startRow][startCol] = 0;
+        // First match wins: promotions are generated queen first
+        Move played = NO_MOVE;
+        for (const auto &m : legalMoves) if (played == NO_MOVE && moveTo(m) == squareOf(row, col)) played = m;
+
+        if (played != NO_MOVE) {
+            // EXECUTE MOVE (castling rook, en passant, promotion and rights)
+            makeMove(game, played);
+            trimHistory(game);
+            syncBoard();
             
             // UPDATE UI & LOGIC
-            lastMove = {startRow, startCol, row, col};
+            lastMove = played;
             whiteTurn = false;
             std::cout << "Move: " << pieceToSymbol(selectedPiece) << toChessNotation(col, row) << std::endl;
 
             lastAITime = SDL_GetTicks(); 
+
+            if (aiThinking) {
+                if (played == ponderMove) {
+                    std::cout << "Ponder hit" << std::endl;
+                    aiPondering = false;
+                } else {
+                    cancelAISearch();
+                }
+            }
             
             checkGameOver(false);
         }
@@ -200,6 +281,19 @@ void handleEvents(SDL_Event &e) {
 // ──────────────────────────────
 int SDL_main(int argc, char* argv[]) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) return -1;
+    initBitboards();
+    initZobrist();
+    initTT(TT_SIZE_MB);
+    setSearchThreads(AI_THREADS);
+    setPositionFromBoard(game, board, whiteTurn,
+                         CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN | CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN);
+
+    // main.exe "<fen>" starts from that position (the FEN may also be unquoted)
+    if (argc > 1) {
+        std::string fen = argv[1];
+        for (int i = 2; i < argc; i++) fen += std::string(" ") + argv[i];
+        if (!loadFen(fen)) std::cout << "Invalid FEN, using the initial position: " << fen << std::endl;
+    }
     SDL_Window* window = SDL_CreateWindow("Chess Engine", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, BOARD_SIZE*SQUARE_SIZE, BOARD_SIZE*SQUARE_SIZE, SDL_WINDOW_SHOWN);
     SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
 
@@ -221,46 +315,40 @@ int SDL_main(int argc, char* argv[]) {
         }
 
         // AI TURN
-       if (!whiteTurn && !aiHasMoved) {
+        if (!whiteTurn && !aiHasMoved) {
             Uint32 now = SDL_GetTicks();
-            if (now - lastAITime > AI_DELAY) {
+            if (!aiThinking && now - lastAITime > AI_DELAY) {
                 std::cout << "AI is thinking..." << std::endl;
-                Move aiMove = getBestMove(board);
-                
-                if (aiMove.fromRow != -1) {
-                    int piece = board[aiMove.fromRow][aiMove.fromCol];
-
-                    if (abs(piece) == 5 && abs(aiMove.toCol - aiMove.fromCol) == 2) {
-                        int row = aiMove.toRow;
-                        // Kingside (g-file, col 6)
-                        if (aiMove.toCol == 6) { 
-                            board[row][5] = board[row][7]; 
-                            board[row][7] = 0; 
-                        }
-                        // Queenside (c-file, col 2)
-                        if (aiMove.toCol == 2) { 
-                            board[row][3] = board[row][0]; 
-                            board[row][0] = 0; 
-                        }
-                    }
-
-                    if(abs(piece) == 5) { if(piece > 0) WhiteKingMoved = true; else BlackKingMoved = true; }
-                    if(abs(piece) == 1) {
-                         if(aiMove.fromRow == 0 && aiMove.fromCol == 0) BlackQueensideRookMoved = true;
-                         if(aiMove.fromRow == 0 && aiMove.fromCol == 7) BlackKingsideRookMoved = true;
-                         // (White rooks technically don't need updates here since AI is black, but good for completeness)
-                    }
-
-                    // Normal Move Execution
-                    board[aiMove.toRow][aiMove.toCol] = piece;
-                    board[aiMove.fromRow][aiMove.fromCol] = 0;
-
-                    std::cout << "AI Moved!" << std::endl;
-                    lastMove = {aiMove.fromRow, aiMove.fromCol, aiMove.toRow, aiMove.toCol};
+                aiPosition = game;
+                startAISearch(false);
+            } else if (aiThinking && aiDone.load(std::memory_order_acquire)) {
+                aiWorker.join();
+                aiThinking = false;
+                Move aiMove = aiResult;
+
+                if (aiMove != NO_MOVE) {
+                    makeMove(game, aiMove);
+                    trimHistory(game);
+                    syncBoard();
+
+                    std::cout << "AI Moved! depth " << searchInfo.depth << ", " << searchInfo.nodes
+                              << " nodes in " << searchInfo.timeMs << " ms, first-move cutoffs "
+                              << searchInfo.firstMoveCutoffPercent() << "%" << std::endl;
+                    std::cout << "Pruned: null move " << searchInfo.nullMoveCutoffs
+                              << ", reverse futility " << searchInfo.reverseFutilityCutoffs
+                              << ", razoring " << searchInfo.razorCutoffs
+                              << ", futility " << searchInfo.futilityPruned
+                              << ", late moves " << searchInfo.lateMovePruned << std::endl;
+                    std::cout << "Extended: checks " << searchInfo.checkExtensions
+                              << ", recaptures " << searchInfo.recaptureExtensions
+                              << ", singular " << searchInfo.singularExtensions << std::endl;
+                    std::cout << "TT hit rate: " << searchInfo.ttHitRate() << "%, hashfull: " << ttHashfull() << "/1000" << std::endl;
+                    lastMove = aiMove;
                     whiteTurn = true;
                     aiHasMoved = true;
                     lastAITime = now;
                     checkGameOver(true);
+                    if (!isGameOver) startPondering();
                 } else {
                     checkGameOver(false);
                     whiteTurn = true; 
@@ -285,6 +373,7 @@ int SDL_main(int argc, char* argv[]) {
         SDL_Delay(16);
     }
 
+    cancelAISearch();
     SDL_DestroyTexture(pTex);
     SDL_DestroyTexture(bTex);
     SDL_DestroyRenderer(renderer);
@@ -1,447 +1,307 @@
-#include <SDL.h>
-#include <iostream>
-#include <vector>
 #include <string>
-#include <cmath>
+
 // ──────────────────────────────
-// Global Variables
+// Fixed-capacity move list
 // ──────────────────────────────
-extern bool WhiteKingMoved;
-extern bool BlackKingMoved;
-extern bool WhiteKingsideRookMoved;
-extern bool WhiteQueensideRookMoved;
-extern bool BlackKingsideRookMoved;
-extern bool BlackQueensideRookMoved;
+// Lives on the stack, so generating moves never touches the heap.
+// No legal chess position has more than 218 moves. Ordering scores are
+// kept in a parallel array so the moves themselves stay 2 bytes each.
+const int MAX_MOVES = 256;
 
-// ───────────────────────────────────────────
-// Helper function for check detections
-// ───────────────────────────────────────────
-bool isSquareAttacked(int targetRow, int targetCol, bool attackerIsWhite, int board[8][8]) {
-    // 1. Check Pawn Attacks (Pawn direction is inverted for detection)
-    int pawnDir = attackerIsWhite ? -1 : 1; 
-    if (targetRow - pawnDir >= 0 && targetRow - pawnDir < 8) {
-        if (targetCol - 1 >= 0) {
-            int p = board[targetRow - pawnDir][targetCol - 1];
-            if ((attackerIsWhite && p == 6) || (!attackerIsWhite && p == -6)) return true;
-        }
-        if (targetCol + 1 < 8) {
-            int p = board[targetRow - pawnDir][targetCol + 1];
-            if ((attackerIsWhite && p == 6) || (!attackerIsWhite && p == -6)) return true;
-        }
-    }
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    int count = 0;
 
-    // 2. Check Knight Attacks
-    int kMoves[8][2] = {{2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}};
-    for (auto &m : kMoves) {
-        int r = targetRow + m[0], c = targetCol + m[1];
-        if (r >= 0 && r < 8 && c >= 0 && c < 8) {
-            int p = board[r][c];
-            if ((attackerIsWhite && p == 2) || (!attackerIsWhite && p == -2)) return true;
-        }
-    }
+    void push_back(Move m) { moves[count++] = m; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    Move &operator[](int i) { return moves[i]; }
+    Move *begin() { return moves; }
+    Move *end() { return moves + count; }
+    const Move *begin() const { return moves; }
+    const Move *end() const { return moves + count; }
+};
 
-    // 3. Check Sliding Attacks (Rook, Bishop, Queen)
-    int dirs[8][2] = {{1,0},{-1,0},{0,1},{0,-1}, {1,1},{1,-1},{-1,1},{-1,-1}};
-    for (int d = 0; d < 8; d++) {
-        for (int i = 1; i < 8; i++) {
-            int r = targetRow + dirs[d][0] * i;
-            int c = targetCol + dirs[d][1] * i;
-            if (r < 0 || r >= 8 || c < 0 || c >= 8) break;
-            
-            int p = board[r][c];
-            if (p != 0) { // Hit a piece
-                // Orthogonal (Rook/Queen)
-                if (d < 4) { 
-                    if (attackerIsWhite && (p == 1 || p == 4)) return true;
-                    if (!attackerIsWhite && (p == -1 || p == -4)) return true;
-                }
-                // Diagonal (Bishop/Queen)
-                else { 
-                    if (attackerIsWhite && (p == 3 || p == 4)) return true;
-                    if (!attackerIsWhite && (p == -3 || p == -4)) return true;
-                }
-                // Also check for King (1 square away)
-                if (i == 1) {
-                    if ((attackerIsWhite && p == 5) || (!attackerIsWhite && p == -5)) return true;
-                }
-                break; // Blocked
-            }
-        }
-    }
-    return false;
+// ──────────────────────────────
+// Coordinate notation, e.g. "e2e4" or "a7a8q"
+// ──────────────────────────────
+std::string moveToString(Move m)
+{
+    std::string s;
+    s += (char)('a' + colOf(moveFrom(m)));
+    s += (char)('8' - rowOf(moveFrom(m)));
+    s += (char)('a' + colOf(moveTo(m)));
+    s += (char)('8' - rowOf(moveTo(m)));
+    if (isPromotion(m)) s += "?rnbq"[promotionType(m)];
+    return s;
 }
 // ──────────────────────────────
-// Move Generator: Pawn
+// Helper: one move per set bit of the target set
 // ──────────────────────────────
-void getPawnMoves(int row, int col, int board[8][8], std::vector<std::pair<int, int>> &moves)
+inline void addMoves(int from, Bitboard targets, MoveList &moves)
 {
-    int piece = board[row][col];
-    if (piece == 0)
-        return; // No piece here
-
-    int direction = (piece > 0) ? -1 : 1; // White up, Black down
-
-    // Forward 1
-    if ((row + direction) >= 0 && (row + direction) < 8 && board[row + direction][col] == 0)
-    {
-        moves.push_back({row + direction, col});
-    }
-
-    // Forward 2 from initial position
-    if ((piece > 0 && row == 6) || (piece < 0 && row == 1))
-    {
-        if ((row + 2 * direction) >= 0 && (row + 2 * direction) < 8 &&
-            board[row + direction][col] == 0 &&
-            board[row + 2 * direction][col] == 0)
-        {
-            moves.push_back({row + 2 * direction, col});
-        }
-    }
-
-    // Diagonal captures (left)
-    if (col > 0 && (row + direction) >= 0 && (row + direction) < 8)
-    {
-        int targetPiece = board[row + direction][col - 1];
-        if (targetPiece != 0 && (targetPiece * piece < 0))
-        { // Enemy piece
-            moves.push_back({row + direction, col - 1});
-        }
-    }
-
-    // Diagonal captures (right)
-    if (col < 7 && (row + direction) >= 0 && (row + direction) < 8)
+    while (targets)
     {
-        int targetPiece = board[row + direction][col + 1];
-        if (targetPiece != 0 && (targetPiece * piece < 0))
-        { // Enemy piece
-            moves.push_back({row + direction, col + 1});
-        }
+        int to = popLsb(targets);
+        moves.push_back(encodeMove(from, to));
     }
 }
 // ──────────────────────────────
-// Move Generator: Knight
+// Helper: pawn moves, expanded into the four promotions on the last row
 // ──────────────────────────────
-void getKnightMoves(int row, int col, int board[8][8], std::vector<std::pair<int, int>> &moves)
+inline void addPawnMoves(int from, Bitboard targets, MoveList &moves)
 {
-    int piece = board[row][col];
-    int knightMoves[8][2] = {
-        {2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}};
-    for (int i = 0; i < 8; i++)
+    while (targets)
     {
-        int newRow = row + knightMoves[i][0];
-        int newCol = col + knightMoves[i][1];
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8)
+        int to = popLsb(targets);
+        if (rowOf(to) == 0 || rowOf(to) == 7)
         {
-            if (board[newRow][newCol] == 0)
-            {
-                // empty
-                moves.push_back({newRow, newCol});
-            }
-            else if ((board[newRow][newCol] < 0 && piece > 0) || (board[newRow][newCol] > 0 && piece < 0))
-            {
-                // occupied
-                moves.push_back({newRow, newCol});
-            }
+            moves.push_back(encodeMove(from, to, MOVE_PROMO_QUEEN));
+            moves.push_back(encodeMove(from, to, MOVE_PROMO_KNIGHT));
+            moves.push_back(encodeMove(from, to, MOVE_PROMO_ROOK));
+            moves.push_back(encodeMove(from, to, MOVE_PROMO_BISHOP));
+        }
+        else
+        {
+            moves.push_back(encodeMove(from, to));
         }
     }
 }
 // ──────────────────────────────
-// Move Generator: Bishop
+// Move Generator: Pawn
 // ──────────────────────────────
-void getBishopMoves(int row, int col, int board[8][8], std::vector<std::pair<int, int>> &moves)
+// Unpinned pawns are pushed all at once by shifting the pawn bitboard;
+// pinned ones are walked individually and kept on their pin line.
+// With capturesOnly, pushes are kept only when they promote.
+void getPawnMoves(const Position &pos, int us, int kingSq, Bitboard checkMask, Bitboard pinned, bool capturesOnly, MoveList &moves)
 {
-    int piece = board[row][col];
-    if (piece == 0)
-        return;
+    Bitboard empty = ~pos.allPieces;
+    int forward = (us == WHITE) ? -8 : 8; // White up, Black down
+    Bitboard startRow = (us == WHITE) ? rowBB(5) : rowBB(2); // One step past the home row
+    Bitboard pushMask = capturesOnly ? (rowBB(0) | rowBB(7)) : ~0ULL;
 
-    // Four diagonal directions: NE, NW, SE, SW
-    // int directions[4][2] = {{1,1}, {1,-1}, {-1,1}, {-1,-1}}; //will use later during code optimization.
+    Bitboard pawns = pos.pieces[us][PAWN] & ~pinned;
+    Bitboard single = ((us == WHITE) ? (pawns >> 8) : (pawns << 8)) & empty;
+    Bitboard twice = ((us == WHITE) ? ((single & startRow) >> 8) : ((single & startRow) << 8)) & empty;
+    single &= checkMask & pushMask;
+    twice &= capturesOnly ? 0 : checkMask;
 
-    for (int i = 1; i < 8; i++)
+    while (single)
     {
-        int newRow = row + i;
-        int newCol = col + i;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8)
-        {
-            if (board[newRow][newCol] == 0)
-            {
-                // empty
-                moves.push_back({newRow, newCol});
-            }
-            else if ((board[newRow][newCol] < 0 && piece > 0) || (board[newRow][newCol] > 0 && piece < 0))
-            {
-                moves.push_back({newRow, newCol});
-                break; // this is important so that the bishop doesn't jump over other pieces.
-            }
-            else
-            {
-                break; // friendly piece blocks
-            }
-        }
+        int to = popLsb(single);
+        addPawnMoves(to - forward, squareBB(to), moves);
     }
-    for (int i = 1; i < 8; i++)
+    while (twice)
     {
-        int newRow = row + i;
-        int newCol = col - i;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8)
-        {
-            if (board[newRow][newCol] == 0)
-            {
-                // empty
-                moves.push_back({newRow, newCol});
-            }
-            else if ((board[newRow][newCol] < 0 && piece > 0) || (board[newRow][newCol] > 0 && piece < 0))
-            {
-                moves.push_back({newRow, newCol});
-                break; // this is important so that the bishop doesn't jump over other pieces.
-            }
-            else
-            {
-                break; // friendly piece blocks
-            }
-        }
+        int to = popLsb(twice);
+        moves.push_back(encodeMove(to - 2 * forward, to, MOVE_DOUBLE_PUSH));
     }
-    for (int i = 1; i < 8; i++)
+
+    // Diagonal captures
+    while (pawns)
     {
-        int newRow = row - i;
-        int newCol = col + i;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8)
-        {
-            if (board[newRow][newCol] == 0)
-            {
-                // empty
-                moves.push_back({newRow, newCol});
-            }
-            else if ((board[newRow][newCol] < 0 && piece > 0) || (board[newRow][newCol] > 0 && piece < 0))
-            {
-                moves.push_back({newRow, newCol});
-                break; // this is important so that the bishop doesn't jump over other pieces.
-            }
-            else
-            {
-                break; // friendly piece blocks
-            }
-        }
+        int from = popLsb(pawns);
+        addPawnMoves(from, PAWN_ATTACKS[us][from] & pos.occupied[us ^ 1] & checkMask, moves);
     }
-    for (int i = 1; i < 8; i++)
+
+    // Pinned pawns
+    Bitboard pinnedPawns = pos.pieces[us][PAWN] & pinned;
+    while (pinnedPawns)
     {
-        int newRow = row - i;
-        int newCol = col - i;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8)
-        {
-            if (board[newRow][newCol] == 0)
-            {
-                // empty
-                moves.push_back({newRow, newCol});
-            }
-            else if ((board[newRow][newCol] < 0 && piece > 0) || (board[newRow][newCol] > 0 && piece < 0))
-            {
-                moves.push_back({newRow, newCol});
-                break; // this is important so that the bishop doesn't jump over other pieces.
-            }
-            else
-            {
-                break; // friendly piece blocks
-            }
-        }
+        int from = popLsb(pinnedPawns);
+        Bitboard pinLine = checkMask & LINE[kingSq][from];
+        Bitboard step = squareBB(from + forward) & empty;
+        addPawnMoves(from, ((PAWN_ATTACKS[us][from] & pos.occupied[us ^ 1]) | (step & pushMask)) & pinLine, moves);
+        if (!capturesOnly && step && (squareBB(from) & ((us == WHITE) ? rowBB(6) : rowBB(1))) &&
+            (squareBB(from + 2 * forward) & empty & pinLine))
+            moves.push_back(encodeMove(from, from + 2 * forward, MOVE_DOUBLE_PUSH));
     }
-}
-// ──────────────────────────────
-// Move Generator: Rook
-// ──────────────────────────────
-void getRookMoves(int row, int col, int board[8][8], std::vector<std::pair<int, int>> &moves)
-{
-    int piece = board[row][col];
-    if (piece == 0)
-        return;
-    int directions[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
-    for (int d = 0; d < 4; d++)
+
+    // En passant: both pawns leave the capturing row at once, which can
+    // uncover a slider on the king, so replay the occupancy and look.
+    if (pos.epSquare != -1)
     {
-        int dx = directions[d][0];
-        int dy = directions[d][1];
-        for (int i = 1; i < 8; i++)
+        int ep = pos.epSquare;
+        int captureSq = ep - forward;
+        Bitboard capturers = PAWN_ATTACKS[us ^ 1][ep] & pos.pieces[us][PAWN];
+        while (capturers)
         {
-            int newRow = row + dx * i;
-            int newCol = col + dy * i;
-
-            if (newRow < 0 || newRow >= 8 || newCol < 0 || newCol >= 8)
-                break;
-            if (board[newRow][newCol] == 0)
-            {
-                moves.push_back({newRow, newCol});
-            }
-            else if ((piece > 0 && board[newRow][newCol] < 0) || (piece < 0 && board[newRow][newCol] > 0))
-            {
-                moves.push_back({newRow, newCol});
-                break;
-            }
-            else
-            {
-                break;
-            }
+            int from = popLsb(capturers);
+            Bitboard occupied = (pos.allPieces ^ squareBB(from) ^ squareBB(captureSq)) | squareBB(ep);
+            Bitboard attackers = attackersTo(pos, kingSq, occupied) & pos.occupied[us ^ 1] & ~squareBB(captureSq);
+            if (!attackers) moves.push_back(encodeMove(from, ep, MOVE_EN_PASSANT));
         }
     }
 }
 // ──────────────────────────────
-// Move Generator: queen
+// Move Generator: Knight, Bishop, Rook, Queen
 // ──────────────────────────────
-void getQueenMoves(int row, int col, int board[8][8], std::vector<std::pair<int, int>> &moves)
+void getPieceMoves(const Position &pos, int us, int kingSq, Bitboard checkMask, Bitboard pinned, bool capturesOnly, MoveList &moves)
 {
-    int piece = board[row][col];
-    int directions[8][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    if (piece == 0)
-        return;
+    Bitboard targets = (capturesOnly ? pos.occupied[us ^ 1] : ~pos.occupied[us]) & checkMask;
+    Bitboard b;
+
+    // A pinned knight can never stay on its pin line
+    b = pos.pieces[us][KNIGHT] & ~pinned;
+    while (b) { int from = popLsb(b); addMoves(from, KNIGHT_ATTACKS[from] & targets, moves); }
 
-    for (int d = 0; d < 8; d++)
+    b = pos.pieces[us][BISHOP] | pos.pieces[us][QUEEN];
+    while (b)
     {
-        int dx = directions[d][0];
-        int dy = directions[d][1];
-        for (int i = 1; i < 8; i++)
-        {
-            int newRow = row + dx * i;
-            int newCol = col + dy * i;
+        int from = popLsb(b);
+        Bitboard attacks = bishopAttacks(from, pos.allPieces) & targets;
+        if (pinned & squareBB(from)) attacks &= LINE[kingSq][from];
+        addMoves(from, attacks, moves);
+    }
 
-            if (newRow < 0 || newRow >= 8 || newCol < 0 || newCol >= 8)
-                break;
-            if (board[newRow][newCol] == 0)
-            {
-                moves.push_back({newRow, newCol});
-            }
-            else if ((piece > 0 && board[newRow][newCol] < 0) || (piece < 0 && board[newRow][newCol] > 0))
-            {
-                moves.push_back({newRow, newCol});
-                break;
-            }
-            else
-            {
-                break;
-            }
-        }
+    b = pos.pieces[us][ROOK] | pos.pieces[us][QUEEN];
+    while (b)
+    {
+        int from = popLsb(b);
+        Bitboard attacks = rookAttacks(from, pos.allPieces) & targets;
+        if (pinned & squareBB(from)) attacks &= LINE[kingSq][from];
+        addMoves(from, attacks, moves);
     }
 }
 // ──────────────────────────────
 // Move Generator: King
 // ──────────────────────────────
-void getKingMoves(int row, int col, int board[8][8], std::vector<std::pair<int, int>> &moves)
+void getKingMoves(const Position &pos, int us, int kingSq, bool inCheck, bool capturesOnly, MoveList &moves)
 {
+    int them = us ^ 1;
 
-    int piece = board[row][col];
-    int directions[8][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    if (piece == 0)
-        return;
-    for (int d = 0; d < 8; d++)
+    // The king is lifted off the board so sliders see through its old square
+    Bitboard occupied = pos.allPieces ^ squareBB(kingSq);
+    Bitboard targets = KING_ATTACKS[kingSq] & (capturesOnly ? pos.occupied[them] : ~pos.occupied[us]);
+    while (targets)
     {
-        int newRow = row + directions[d][0];
-        int newCol = col + directions[d][1];
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8)
-        {
-            if (board[newRow][newCol] == 0 ||
-                (piece > 0 && board[newRow][newCol] < 0) ||
-                (piece < 0 && board[newRow][newCol] > 0))
-            {
-                moves.push_back({newRow, newCol});
-            }
-        }
+        int to = popLsb(targets);
+        if (!(attackersTo(pos, to, occupied) & pos.occupied[them]))
+            moves.push_back(encodeMove(kingSq, to));
     }
+
     // ──────────────────────────────
-    // Castling logic for white king
-    //  ──────────────────────────────
-    if(abs(piece) == 5){ //for identifying the king.
-        if (piece > 0 && !WhiteKingMoved && row == 7 && col == 4)
-        {
-            // kingside
-            if (!WhiteKingsideRookMoved && 
-                board[7][5] == 0 && 
-                board[7][6] == 0)
-            {
-                moves.push_back({7, 6});
-            }
-            // queenside
-            if (!WhiteQueensideRookMoved && 
-                board[7][3] == 0 && 
-                board[7][2] == 0 && 
-                board[7][1] == 0)
-            {
-                moves.push_back({7, 2});
-            }
-        }
-        // ──────────────────────────────
-        // Castling logic for Black king
-        // ──────────────────────────────
-        else if(piece < 0 && !BlackKingMoved && row == 0 && col == 4)
-        {
-            // kingside
-            if (!BlackKingsideRookMoved && 
-                board[0][5] == 0 && 
-                board[0][6] == 0)
-            {
-                moves.push_back({0, 6});
-            }
-            // queenside
-            if (!BlackQueensideRookMoved && 
-                board[0][3] == 0 && 
-                board[0][2] == 0 && 
-                board[0][1] == 0)
-            {
-                moves.push_back({0, 2});
-            }
-        }
+    // Castling logic
+    // ──────────────────────────────
+    // The king may not castle out of, through or into check.
+    bool byWhite = (them == WHITE);
+    int row = (us == WHITE) ? 7 : 0;
+    int kingsideRight = (us == WHITE) ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+    int queensideRight = (us == WHITE) ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
+
+    if (capturesOnly || inCheck || kingSq != squareOf(row, 4) || !(pos.castling & (kingsideRight | queensideRight))) return;
+
+    // kingside
+    if ((pos.castling & kingsideRight) &&
+        pos.squares[squareOf(row, 5)] == 0 &&
+        pos.squares[squareOf(row, 6)] == 0 &&
+        !isSquareAttacked(pos, squareOf(row, 5), byWhite) &&
+        !isSquareAttacked(pos, squareOf(row, 6), byWhite))
+    {
+        moves.push_back(encodeMove(kingSq, squareOf(row, 6), MOVE_CASTLING));
+    }
+    // queenside
+    if ((pos.castling & queensideRight) &&
+        pos.squares[squareOf(row, 3)] == 0 &&
+        pos.squares[squareOf(row, 2)] == 0 &&
+        pos.squares[squareOf(row, 1)] == 0 &&
+        !isSquareAttacked(pos, squareOf(row, 3), byWhite) &&
+        !isSquareAttacked(pos, squareOf(row, 2), byWhite))
+    {
+        moves.push_back(encodeMove(kingSq, squareOf(row, 2), MOVE_CASTLING));
     }
 }
 // ──────────────────────────────
 // Dispatcher: Legal Moves
 // ──────────────────────────────
-std::vector<std::pair<int, int>> getLegalMoves(int row, int col, int board[8][8])
+// Checkers, pinned pieces and the check-evasion mask are worked out once,
+// so every move emitted below is already legal and nothing is played and
+// taken back to test it. capturesOnly leaves out quiet moves (but keeps
+// promotions) for the quiescence search.
+void generateLegalMoves(const Position &pos, bool whiteTurn, MoveList &moves, bool capturesOnly = false)
 {
-    std::vector<std::pair<int, int>> rawMoves; // Temporary list
-    int piece = board[row][col];
-    if (piece == 0) return rawMoves;
+    int us = whiteTurn ? WHITE : BLACK;
+    int them = us ^ 1;
+    int kingSq = kingSquare(pos, us);
 
-    // 1. Get Geometry-based moves (Same as before, but into rawMoves)
-    switch (abs(piece))
-    {
-    case 1: getRookMoves(row, col, board, rawMoves); break;
-    case 2: getKnightMoves(row, col, board, rawMoves); break;
-    case 3: getBishopMoves(row, col, board, rawMoves); break;
-    case 4: getQueenMoves(row, col, board, rawMoves); break;
-    case 5: getKingMoves(row, col, board, rawMoves); break;
-    case 6: getPawnMoves(row, col, board, rawMoves); break;
-    }
+    Bitboard checkers = attackersTo(pos, kingSq, pos.allPieces) & pos.occupied[them];
+    getKingMoves(pos, us, kingSq, checkers != 0, capturesOnly, moves);
+    if (popCount(checkers) > 1) return; // Double check: only the king can move
 
-    // 2. Filter: Remove moves that leave the King in check
-    std::vector<std::pair<int, int>> finalMoves;
-    bool isWhite = (piece > 0);
+    // In check, other pieces must capture the checker or block its ray
+    Bitboard checkMask = ~0ULL;
+    if (checkers) checkMask = checkers | BETWEEN[kingSq][bitScan(checkers)];
 
-    for (const auto &move : rawMoves)
+    // A piece is pinned when it is the only one between our king and an enemy slider
+    Bitboard pinned = 0;
+    Bitboard snipers = (rookAttacks(kingSq, 0) & (pos.pieces[them][ROOK] | pos.pieces[them][QUEEN])) |
+                       (bishopAttacks(kingSq, 0) & (pos.pieces[them][BISHOP] | pos.pieces[them][QUEEN]));
+    while (snipers)
     {
-        int targetRow = move.first;
-        int targetCol = move.second;
-        
-        // A. Make the move temporarily
-        int originalTargetPiece = board[targetRow][targetCol];
-        board[targetRow][targetCol] = piece;
-        board[row][col] = 0;
+        Bitboard blockers = BETWEEN[kingSq][popLsb(snipers)] & pos.allPieces;
+        if (popCount(blockers) == 1) pinned |= blockers & pos.occupied[us];
+    }
 
-        // B. Find my King's location
-        int kingRow = -1, kingCol = -1;
-        for(int r=0; r<8; r++) {
-            for(int c=0; c<8; c++) {
-                if(board[r][c] == (isWhite ? 5 : -5)) {
-                    kingRow = r; kingCol = c;
-                }
-            }
-        }
+    getPawnMoves(pos, us, kingSq, checkMask, pinned, capturesOnly, moves);
+    getPieceMoves(pos, us, kingSq, checkMask, pinned, capturesOnly, moves);
+}
+// ──────────────────────────────
+// Standard algebraic notation, e.g. "Nbd7", "exd5" or "e8=Q"
+// ──────────────────────────────
+// Without the +/# suffix, which test suites write inconsistently anyway.
+std::string moveToSan(const Position &pos, Move m)
+{
+    int from = moveFrom(m), to = moveTo(m);
+    int type = abs(pos.squares[from]);
+    if (moveFlag(m) == MOVE_CASTLING) return colOf(to) == 6 ? "O-O" : "O-O-O";
 
-        // C. Check if King is attacked (Pass !isWhite because we check if ENEMY attacks us)
-        if (kingRow != -1 && !isSquareAttacked(kingRow, kingCol, !isWhite, board)) {
-            finalMoves.push_back(move);
+    std::string san;
+    bool capture = pos.squares[to] != 0 || moveFlag(m) == MOVE_EN_PASSANT;
+    if (type == PAWN)
+    {
+        if (capture) san += (char)('a' + colOf(from));
+    }
+    else
+    {
+        san += "?RNBQK"[type];
+        // Name the origin file, rank or both if another piece of the
+        // same type can also reach the square
+        MoveList legal;
+        generateLegalMoves(pos, pos.whiteToMove, legal);
+        bool ambiguous = false, sameFile = false, sameRow = false;
+        for (Move other : legal)
+        {
+            int otherFrom = moveFrom(other);
+            if (other == m || moveTo(other) != to || abs(pos.squares[otherFrom]) != type) continue;
+            ambiguous = true;
+            if (colOf(otherFrom) == colOf(from)) sameFile = true;
+            if (rowOf(otherFrom) == rowOf(from)) sameRow = true;
         }
-
-        // D. Undo the move
-        board[row][col] = piece;
-        board[targetRow][targetCol] = originalTargetPiece;
+        if (ambiguous && (!sameFile || sameRow)) san += (char)('a' + colOf(from));
+        if (ambiguous && sameFile) san += (char)('8' - rowOf(from));
     }
-
-    return finalMoves;
+    if (capture) san += 'x';
+    san += (char)('a' + colOf(to));
+    san += (char)('8' - rowOf(to));
+    if (isPromotion(m)) san += std::string("=") + "?RNBQ"[promotionType(m)];
+    return san;
 }
+// ──────────────────────────────
+// Legal Moves for a single piece (GUI)
+// ──────────────────────────────
+void getLegalMoves(const Position &pos, int row, int col, MoveList &moves)
+{
+    moves.clear();
+    int piece = pos.squares[squareOf(row, col)];
+    if (piece == 0) return;
 
+    MoveList legal;
+    generateLegalMoves(pos, piece > 0, legal);
+    for (const auto &m : legal)
+    {
+        if (moveFrom(m) == squareOf(row, col))
+            moves.push_back(m);
+    }
+}
@@ -0,0 +1,434 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "bitboard.cpp"
+#include "zobrist.cpp"
+#include "position.cpp"
+#include "move.cpp"
+#include "tt.cpp"
+#include "ai.cpp"
+
+// ──────────────────────────────
+// Shared perft hash (lock-free)
+// ──────────────────────────────
+// Maps (key, depth) to a leaf count so transposed subtrees are counted once.
+// Each entry stores key ^ data next to data: if two threads race on a slot
+// and the halves get mixed up, the check simply fails and it is a miss.
+struct PerftEntry {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data; // nodes << 8 | depth
+};
+
+PerftEntry* perftTable = nullptr;
+uint64_t perftTableMask = 0;
+
+void initPerftHash(int megabytes) {
+    delete[] perftTable;
+    perftTable = nullptr;
+    perftTableMask = 0;
+    if (megabytes <= 0) return;
+
+    uint64_t entries = 1;
+    while (entries * 2 * sizeof(PerftEntry) <= (uint64_t)megabytes * 1024 * 1024) entries *= 2;
+    perftTable = new PerftEntry[entries];
+    perftTableMask = entries - 1;
+    for (uint64_t i = 0; i < entries; i++) {
+        perftTable[i].check.store(0, std::memory_order_relaxed);
+        perftTable[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline PerftEntry &perftSlot(uint64_t key, int depth) {
+    // Different depths of one position land in different slots
+    return perftTable[(key ^ (depth * 0x9E3779B97F4A7C15ULL)) & perftTableMask];
+}
+
+inline bool probePerft(uint64_t key, int depth, long long &nodes) {
+    PerftEntry &e = perftSlot(key, depth);
+    uint64_t data = e.data.load(std::memory_order_relaxed);
+    uint64_t check = e.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || (int)(data & 0xFF) != depth) return false;
+    nodes = (long long)(data >> 8);
+    return true;
+}
+
+inline void storePerft(uint64_t key, int depth, long long nodes) {
+    PerftEntry &e = perftSlot(key, depth);
+    uint64_t data = ((uint64_t)nodes << 8) | (uint64_t)depth;
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+// ──────────────────────────────
+// Perft: count leaf nodes of the legal move tree
+// ──────────────────────────────
+long long perft(Position &pos, int depth) {
+    if (depth == 0) return 1;
+
+    // Depth 1 is cheaper to count than to look up
+    long long nodes = 0;
+    if (perftTable && depth >= 2 && probePerft(pos.key, depth, nodes)) return nodes;
+
+    MoveList moves;
+    generateAllMoves(pos, pos.whiteToMove, moves);
+    if (depth == 1) return moves.size(); // Bulk count: the last ply is never played
+
+    for (Move m : moves) {
+        makeMove(pos, m);
+        nodes += perft(pos, depth - 1);
+        unmakeMove(pos);
+    }
+
+    if (perftTable) storePerft(pos.key, depth, nodes);
+    return nodes;
+}
+
+// ──────────────────────────────
+// Work-stealing perft scheduler
+// ──────────────────────────────
+// A task is a subtree: the moves leading to it from the root and the depth
+// left below it. Deep tasks are split into one task per child, pushed onto
+// the owner's deque. Owners take from the back (depth-first, cache-warm)
+// and idle threads steal from the front, where the biggest subtrees sit.
+const int MAX_SPLIT_PLY = 8;
+const int SPLIT_DEPTH = 5; // Tasks deeper than this are split further
+
+struct PerftTask {
+    Move path[MAX_SPLIT_PLY];
+    int pathLength;
+    int depth;
+    int rootIndex; // Root move the subtree belongs to, for divide
+};
+
+struct WorkerQueue {
+    std::mutex lock;
+    std::deque<PerftTask> tasks;
+};
+
+struct PerftStats {
+    long long nodes = 0;  // Leaves counted by this thread
+    long long tasks = 0;
+    long long steals = 0;
+    double busySeconds = 0;
+};
+
+struct PerftPool {
+    const Position* root;
+    std::vector<WorkerQueue> queues;
+    std::vector<PerftStats> stats;
+    std::vector<std::atomic<long long>> rootCounts;
+    std::atomic<long long> pending{0}; // Tasks queued or running
+
+    PerftPool(int threads, int rootMoves)
+        : queues(threads), stats(threads), rootCounts(rootMoves) {}
+};
+
+void pushTask(PerftPool &pool, int worker, const PerftTask &task) {
+    pool.pending++;
+    std::lock_guard<std::mutex> guard(pool.queues[worker].lock);
+    pool.queues[worker].tasks.push_back(task);
+}
+
+bool takeTask(PerftPool &pool, int worker, PerftTask &task) {
+    std::lock_guard<std::mutex> guard(pool.queues[worker].lock);
+    if (pool.queues[worker].tasks.empty()) return false;
+    task = pool.queues[worker].tasks.back();
+    pool.queues[worker].tasks.pop_back();
+    return true;
+}
+
+bool stealTask(PerftPool &pool, int worker, PerftTask &task) {
+    int count = (int)pool.queues.size();
+    for (int i = 1; i < count; i++) {
+        WorkerQueue &victim = pool.queues[(worker + i) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.tasks.empty()) continue;
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void perftWorker(PerftPool &pool, int worker) {
+    Position pos = *pool.root; // Private copy, walked with make/unmake
+    PerftStats &stats = pool.stats[worker];
+
+    while (pool.pending > 0) {
+        PerftTask task;
+        bool stolen = false;
+        if (!takeTask(pool, worker, task)) {
+            if (!stealTask(pool, worker, task)) {
+                std::this_thread::yield();
+                continue;
+            }
+            stolen = true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < task.pathLength; i++) makeMove(pos, task.path[i]);
+
+        if (task.depth > SPLIT_DEPTH && task.pathLength < MAX_SPLIT_PLY) {
+            MoveList moves;
+            generateAllMoves(pos, pos.whiteToMove, moves);
+            for (Move m : moves) {
+                PerftTask child = task;
+                child.path[child.pathLength++] = m;
+                child.depth--;
+                pushTask(pool, worker, child);
+            }
+        } else {
+            long long nodes = perft(pos, task.depth);
+            pool.rootCounts[task.rootIndex] += nodes;
+            stats.nodes += nodes;
+        }
+
+        for (int i = 0; i < task.pathLength; i++) unmakeMove(pos);
+        stats.busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.tasks++;
+        if (stolen) stats.steals++;
+        pool.pending--; // After the children were pushed, so it never hits 0 early
+    }
+}
+
+// Runs perft on all threads. rootCounts receives one count per root move
+// (in generation order) and stats one entry per thread.
+long long parallelPerft(const Position &root, int depth, int threads,
+                        MoveList &rootMoves, std::vector<long long> &rootCounts, std::vector<PerftStats> &stats) {
+    generateAllMoves(root, root.whiteToMove, rootMoves);
+    PerftPool pool(threads, rootMoves.size());
+    pool.root = &root;
+    for (auto &count : pool.rootCounts) count = 0;
+
+    // Deal the root moves round-robin so every thread starts with work
+    for (int i = 0; i < rootMoves.size(); i++) {
+        PerftTask task;
+        task.path[0] = rootMoves[i];
+        task.pathLength = 1;
+        task.depth = depth - 1;
+        task.rootIndex = i;
+        pushTask(pool, i % threads, task);
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) workers.emplace_back(perftWorker, std::ref(pool), t);
+    perftWorker(pool, 0);
+    for (auto &w : workers) w.join();
+
+    long long total = 0;
+    rootCounts.assign(rootMoves.size(), 0);
+    for (int i = 0; i < rootMoves.size(); i++) total += rootCounts[i] = pool.rootCounts[i];
+    stats = pool.stats;
+    return total;
+}
+
+// Perft with the node count of every root move printed separately
+long long divide(Position &pos, int depth, int threads, bool verbose) {
+    if (depth == 1) {
+        MoveList moves;
+        generateAllMoves(pos, pos.whiteToMove, moves);
+        if (verbose) for (Move m : moves) std::cout << moveToString(m) << ": 1" << std::endl;
+        return moves.size();
+    }
+
+    MoveList rootMoves;
+    std::vector<long long> rootCounts;
+    std::vector<PerftStats> stats;
+    long long total = parallelPerft(pos, depth, threads, rootMoves, rootCounts, stats);
+    if (!verbose) return total;
+
+    for (int i = 0; i < rootMoves.size(); i++)
+        std::cout << moveToString(rootMoves[i]) << ": " << rootCounts[i] << std::endl;
+
+    if (threads > 1) {
+        std::cout << std::endl << "Thread  Nodes            Tasks   Steals  Busy" << std::endl;
+        for (int t = 0; t < threads; t++) {
+            std::cout << std::left << std::setw(8) << t << std::setw(17) << stats[t].nodes
+                      << std::setw(8) << stats[t].tasks << std::setw(8) << stats[t].steals
+                      << std::right << std::fixed << std::setprecision(3) << stats[t].busySeconds << "s" << std::endl;
+        }
+    }
+    return total;
+}
+
+// ──────────────────────────────
+// Scaling: same perft with 1, 2, 4, ... threads
+// ──────────────────────────────
+// The hash is cleared before each run so every run does the same work.
+void runScaling(Position &pos, int depth, int maxThreads, int hashMB) {
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) counts.push_back(threads);
+    counts.push_back(maxThreads);
+
+    std::cout << "Threads  Time      Speedup  Efficiency" << std::endl;
+    double baseSeconds = 0;
+    for (int threads : counts) {
+        initPerftHash(hashMB);
+        auto start = std::chrono::steady_clock::now();
+        divide(pos, depth, threads, false);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (threads == 1) baseSeconds = seconds;
+
+        double speedup = baseSeconds / (seconds > 0 ? seconds : 1e-9);
+        std::cout << std::left << std::setw(9) << threads << std::right << std::fixed << std::setprecision(3)
+                  << seconds << "s    " << std::setprecision(2) << speedup << "x    "
+                  << std::setprecision(0) << 100.0 * speedup / threads << "%" << std::endl;
+    }
+}
+
+// ──────────────────────────────
+// Regression suite: well-known positions and their published counts
+// ──────────────────────────────
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    long long counts[7]; // Leaf counts for depth 1, 2, ... (0 = not listed)
+};
+
+const PerftCase PERFT_SUITE[] = {
+    {"Start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603, 193690690}},
+    {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238, 674624, 11030083, 178633661}},
+    {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333, 15833292}},
+    {"Position 4 (mirrored)", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+     {6, 264, 9467, 422333, 15833292}},
+    {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487, 89941194}},
+    {"Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+     {46, 2079, 89890, 3894594, 164075551}},
+};
+
+// FENs setPositionFromFen must reject: with them the generator would play
+// moves that do not exist
+const PerftCase INVALID_FENS[] = {
+    {"En passant behind own pawn", "4k3/8/8/8/8/8/3PP3/4K3 w - e3 0 1", {}},
+    {"En passant with no pawn to take", "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1", {}},
+};
+
+// Runs every suite position up to maxDepth. Returns the number of failures.
+int runSuite(int maxDepth, int threads) {
+    int failures = 0;
+    long long totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const PerftCase &c : INVALID_FENS) {
+        Position pos;
+        bool ok = !setPositionFromFen(pos, c.fen);
+        if (!ok) failures++;
+        std::cout << (ok ? "  ok   " : "  FAIL ") << c.name << ": " << (ok ? "rejected" : "accepted") << std::endl;
+    }
+
+    for (const PerftCase &c : PERFT_SUITE) {
+        Position pos;
+        if (!setPositionFromFen(pos, c.fen)) {
+            failures++;
+            std::cout << "  FAIL " << c.name << ": invalid fen" << std::endl;
+            continue;
+        }
+
+        // Writing the position back out must give the FEN it was read from
+        std::string fen = positionToFen(pos);
+        if (fen != c.fen) {
+            failures++;
+            std::cout << "  FAIL " << c.name << " FEN round trip: " << fen << std::endl;
+        }
+
+        for (int depth = 1; depth <= maxDepth && depth <= 7 && c.counts[depth - 1] != 0; depth++) {
+            long long nodes = divide(pos, depth, threads, false);
+            bool ok = (nodes == c.counts[depth - 1]);
+            if (!ok) failures++;
+            totalNodes += nodes;
+            std::cout << (ok ? "  ok   " : "  FAIL ") << c.name << " depth " << depth
+                      << ": " << nodes;
+            if (!ok) std::cout << " (expected " << c.counts[depth - 1] << ")";
+            std::cout << std::endl;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::endl << "Nodes: " << totalNodes << "  Time: " << std::fixed << std::setprecision(2)
+              << seconds << "s  NPS: " << (long long)(totalNodes / (seconds > 0 ? seconds : 1e-9)) << std::endl;
+    if (failures) std::cout << failures << " FAILED" << std::endl;
+    else std::cout << "All passed" << std::endl;
+    return failures;
+}
+
+// ──────────────────────────────
+// Entry point
+// ──────────────────────────────
+//   perft [options] <depth> [fen]      divide counts, total nodes and nodes/second
+//   perft [options] suite [maxDepth]   regression suite (default depth 5)
+//   perft [options] scaling <depth> [fen]
+// options: -threads N (default: all cores), -hash MB (default 64, 0 = off)
+int main(int argc, char* argv[]) {
+    initBitboards();
+    initZobrist();
+
+    int threads = (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    int hashMB = 64;
+
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-hash" && i + 1 < argc) hashMB = std::atoi(argv[++i]);
+        else args.push_back(a);
+    }
+
+    if (args.empty()) {
+        std::cout << "usage: perft [-threads N] [-hash MB] <depth> [fen]" << std::endl
+                  << "       perft [-threads N] [-hash MB] suite [maxDepth]" << std::endl
+                  << "       perft [-threads N] [-hash MB] scaling <depth> [fen]" << std::endl;
+        return 1;
+    }
+
+    initPerftHash(hashMB);
+
+    if (args[0] == "suite") {
+        int maxDepth = (args.size() > 1) ? std::atoi(args[1].c_str()) : 5;
+        return runSuite(maxDepth, threads) ? 1 : 0;
+    }
+
+    bool scaling = (args[0] == "scaling");
+    if (scaling) args.erase(args.begin());
+
+    int depth = args.empty() ? 0 : std::atoi(args[0].c_str());
+    std::string fen = START_FEN;
+    if (args.size() > 1) {
+        fen = args[1];
+        for (size_t i = 2; i < args.size(); i++) fen += " " + args[i]; // Unquoted FEN
+    }
+
+    Position pos;
+    if (depth < 1 || !setPositionFromFen(pos, fen)) {
+        std::cout << "Invalid depth or FEN" << std::endl;
+        return 1;
+    }
+
+    if (scaling) {
+        runScaling(pos, depth, threads, hashMB);
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long long nodes = divide(pos, depth, threads, true);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::endl << "Nodes: " << nodes << std::endl
+              << "Time: " << std::fixed << std::setprecision(3) << seconds << "s" << std::endl
+              << "NPS: " << (long long)(nodes / (seconds > 0 ? seconds : 1e-9)) << std::endl;
+    return 0;
+}
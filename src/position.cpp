@@ -0,0 +1,470 @@
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <cctype>
+
+// ──────────────────────────────
+// Packed 16-bit move
+// ──────────────────────────────
+// bits 0-5: from square, bits 6-11: to square, bits 12-15: MOVE_* flag
+typedef uint16_t Move;
+
+const Move NO_MOVE = 0; // a8 -> a8 is never a real move
+
+const int MOVE_NORMAL = 0;
+const int MOVE_DOUBLE_PUSH = 1;
+const int MOVE_CASTLING = 2;
+const int MOVE_EN_PASSANT = 3;
+const int MOVE_PROMO_KNIGHT = 4; // Promotions are 4-7, in the order N, B, R, Q
+const int MOVE_PROMO_BISHOP = 5;
+const int MOVE_PROMO_ROOK = 6;
+const int MOVE_PROMO_QUEEN = 7;
+
+inline Move encodeMove(int from, int to, int flag = MOVE_NORMAL) {
+    return (Move)(from | (to << 6) | (flag << 12));
+}
+inline int moveFrom(Move m) { return m & 63; }
+inline int moveTo(Move m) { return (m >> 6) & 63; }
+inline int moveFlag(Move m) { return m >> 12; }
+inline bool isPromotion(Move m) { return moveFlag(m) >= MOVE_PROMO_KNIGHT; }
+
+// Piece type a promotion turns into
+inline int promotionType(Move m) {
+    const int types[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+    return types[moveFlag(m) - MOVE_PROMO_KNIGHT];
+}
+
+// ──────────────────────────────────────────────
+// POSITION (Bitboards + Mailbox)
+// ──────────────────────────────────────────────
+// Castling rights bitmask
+const int CASTLE_WHITE_KING = 1;
+const int CASTLE_WHITE_QUEEN = 2;
+const int CASTLE_BLACK_KING = 4;
+const int CASTLE_BLACK_QUEEN = 8;
+
+// Castling rights that survive a move touching each square: moving the
+// king or a rook, or capturing a rook on its corner, clears the right.
+const int CASTLING_KEEP[64] = {
+     7, 15, 15, 15,  3, 15, 15, 11,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    13, 15, 15, 15, 12, 15, 15, 14
+};
+
+// Game plus search plies the undo stack can hold
+const int MAX_GAME_PLY = 1024;
+
+// Everything makeMove destroys and unmakeMove needs back
+struct UndoInfo {
+    Move move;
+    int8_t captured;      // Signed piece code, 0 if none
+    uint8_t castling;
+    int8_t epSquare;
+    uint16_t halfmoveClock;
+    uint64_t key;
+};
+
+struct Position {
+    Bitboard pieces[2][7]; // [color][pieceType], index 0 unused
+    Bitboard occupied[2];  // All pieces of one color
+    Bitboard allPieces;
+    int squares[64];       // Same signed piece codes as board[8][8]
+    bool whiteToMove;
+    int castling;          // CASTLE_* bits
+    int epSquare;          // Square behind a pawn that just moved two, -1 if none
+    int halfmoveClock;     // Plies since the last capture or pawn move
+    int fullmoveNumber;
+    uint64_t key;          // Zobrist key, updated incrementally
+
+    UndoInfo history[MAX_GAME_PLY];
+    int historyCount;
+};
+
+inline int colorOf(int piece) { return piece > 0 ? WHITE : BLACK; }
+
+inline void putPiece(Position &pos, int sq, int piece) {
+    Bitboard b = squareBB(sq);
+    pos.pieces[colorOf(piece)][abs(piece)] |= b;
+    pos.occupied[colorOf(piece)] |= b;
+    pos.allPieces |= b;
+    pos.squares[sq] = piece;
+    pos.key ^= ZOBRIST_PIECE[colorOf(piece)][abs(piece)][sq];
+}
+
+inline void removePiece(Position &pos, int sq) {
+    int piece = pos.squares[sq];
+    Bitboard b = squareBB(sq);
+    pos.pieces[colorOf(piece)][abs(piece)] &= ~b;
+    pos.occupied[colorOf(piece)] &= ~b;
+    pos.allPieces &= ~b;
+    pos.squares[sq] = 0;
+    pos.key ^= ZOBRIST_PIECE[colorOf(piece)][abs(piece)][sq];
+}
+
+inline int kingSquare(const Position &pos, int color) {
+    return bitScan(pos.pieces[color][KING]);
+}
+
+// Key of the whole position, built from scratch
+uint64_t computeKey(const Position &pos) {
+    uint64_t key = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int t = ROOK; t <= PAWN; t++) {
+            Bitboard b = pos.pieces[c][t];
+            while (b) key ^= ZOBRIST_PIECE[c][t][popLsb(b)];
+        }
+    }
+    key ^= ZOBRIST_CASTLING[pos.castling];
+    if (pos.epSquare != -1) key ^= ZOBRIST_EP_FILE[colOf(pos.epSquare)];
+    if (!pos.whiteToMove) key ^= ZOBRIST_BLACK_TO_MOVE;
+    return key;
+}
+
+// A right only exists while king and rook are still on their squares
+void dropLostCastlingRights(Position &pos) {
+    if (pos.squares[squareOf(7, 4)] != KING) pos.castling &= ~(CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN);
+    if (pos.squares[squareOf(0, 4)] != -KING) pos.castling &= ~(CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN);
+    if (pos.squares[squareOf(7, 7)] != ROOK) pos.castling &= ~CASTLE_WHITE_KING;
+    if (pos.squares[squareOf(7, 0)] != ROOK) pos.castling &= ~CASTLE_WHITE_QUEEN;
+    if (pos.squares[squareOf(0, 7)] != -ROOK) pos.castling &= ~CASTLE_BLACK_KING;
+    if (pos.squares[squareOf(0, 0)] != -ROOK) pos.castling &= ~CASTLE_BLACK_QUEEN;
+}
+
+const std::string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Builds a position from the GUI board. castling holds the CASTLE_* rights
+// the GUI still grants.
+void setPositionFromBoard(Position &pos, int board[8][8], bool whiteToMove, int castling) {
+    for (int c = 0; c < 2; c++) {
+        for (int t = 0; t < 7; t++) pos.pieces[c][t] = 0;
+        pos.occupied[c] = 0;
+    }
+    pos.allPieces = 0;
+    pos.key = 0;
+
+    for (int sq = 0; sq < 64; sq++) {
+        pos.squares[sq] = 0;
+        int piece = board[rowOf(sq)][colOf(sq)];
+        if (piece != 0) putPiece(pos, sq, piece);
+    }
+    pos.whiteToMove = whiteToMove;
+    pos.epSquare = -1;
+    pos.halfmoveClock = 0;
+    pos.fullmoveNumber = 1;
+    pos.historyCount = 0;
+
+    pos.castling = castling;
+    dropLostCastlingRights(pos);
+    pos.key = computeKey(pos);
+}
+
+bool isSquareAttacked(const Position &pos, int sq, bool attackerIsWhite);
+
+// Builds a position from a FEN string. Returns false if it is malformed or
+// not a position that can arise in a game; out is then left as it was.
+bool setPositionFromFen(Position &out, const std::string &fen) {
+    Position pos;
+    std::istringstream in(fen);
+    std::string placement, side, rights, ep;
+    int halfmove = 0, fullmove = 1;
+    if (!(in >> placement >> side >> rights >> ep)) return false;
+    in >> halfmove >> fullmove; // Move clocks are optional
+
+    for (int c = 0; c < 2; c++) {
+        for (int t = 0; t < 7; t++) pos.pieces[c][t] = 0;
+        pos.occupied[c] = 0;
+    }
+    pos.allPieces = 0;
+    pos.key = 0;
+    for (int sq = 0; sq < 64; sq++) pos.squares[sq] = 0;
+
+    // Piece placement, rank 8 first - the same order as our squares. Every
+    // rank must cover exactly 8 squares, and there must be exactly 8 ranks.
+    const std::string letters = "rnbqkp";
+    const int types[6] = {ROOK, KNIGHT, BISHOP, QUEEN, KING, PAWN};
+    int row = 0, col = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            if (col != 8 || ++row > 7) return false;
+            col = 0;
+            continue;
+        }
+        if (ch >= '1' && ch <= '8') {
+            col += ch - '0';
+            if (col > 8) return false;
+            continue;
+        }
+        size_t idx = letters.find((char)tolower(ch));
+        if (idx == std::string::npos || col > 7) return false;
+        if (types[idx] == PAWN && (row == 0 || row == 7)) return false;
+        putPiece(pos, squareOf(row, col++), isupper(ch) ? types[idx] : -types[idx]);
+    }
+    if (row != 7 || col != 8) return false;
+    if (popCount(pos.pieces[WHITE][KING]) != 1 || popCount(pos.pieces[BLACK][KING]) != 1) return false;
+
+    if (side != "w" && side != "b") return false;
+    pos.whiteToMove = (side == "w");
+
+    // The side that just moved cannot have left its king in check: the
+    // search would capture it
+    int us = pos.whiteToMove ? WHITE : BLACK;
+    if (isSquareAttacked(pos, kingSquare(pos, us ^ 1), us == WHITE)) return false;
+
+    pos.castling = 0;
+    for (char ch : rights) {
+        if (ch == 'K') pos.castling |= CASTLE_WHITE_KING;
+        if (ch == 'Q') pos.castling |= CASTLE_WHITE_QUEEN;
+        if (ch == 'k') pos.castling |= CASTLE_BLACK_KING;
+        if (ch == 'q') pos.castling |= CASTLE_BLACK_QUEEN;
+    }
+    dropLostCastlingRights(pos);
+
+    // The en passant square is behind a pawn of the side that just moved,
+    // which came from the square behind it: both must be empty. Same rule
+    // as makeMove: keep the square only if a pawn can take there.
+    pos.epSquare = -1;
+    if (ep != "-") {
+        if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || ep[1] != (pos.whiteToMove ? '6' : '3')) return false;
+        int epSq = squareOf('8' - ep[1], ep[0] - 'a');
+        int ahead = pos.whiteToMove ? 8 : -8; // Toward the pawn that moved
+        if (pos.squares[epSq + ahead] != (pos.whiteToMove ? -PAWN : PAWN)) return false;
+        if (pos.squares[epSq] != 0 || pos.squares[epSq - ahead] != 0) return false;
+        if (PAWN_ATTACKS[us ^ 1][epSq] & pos.pieces[us][PAWN]) pos.epSquare = epSq;
+    }
+
+    pos.halfmoveClock = halfmove;
+    pos.fullmoveNumber = fullmove;
+    pos.historyCount = 0;
+    pos.key = computeKey(pos);
+    out = pos;
+    return true;
+}
+
+// The FEN of a position. The en passant square is only written when a pawn
+// can actually take there, as setPositionFromFen and makeMove keep it.
+std::string positionToFen(const Position &pos) {
+    std::string fen;
+    for (int row = 0; row < 8; row++) {
+        int empty = 0;
+        for (int col = 0; col < 8; col++) {
+            int piece = pos.squares[squareOf(row, col)];
+            if (piece == 0) { empty++; continue; }
+            if (empty) fen += (char)('0' + empty);
+            empty = 0;
+            char letter = "?rnbqkp"[abs(piece)];
+            fen += (piece > 0) ? (char)toupper(letter) : letter;
+        }
+        if (empty) fen += (char)('0' + empty);
+        if (row < 7) fen += '/';
+    }
+
+    fen += pos.whiteToMove ? " w " : " b ";
+    if (pos.castling & CASTLE_WHITE_KING) fen += 'K';
+    if (pos.castling & CASTLE_WHITE_QUEEN) fen += 'Q';
+    if (pos.castling & CASTLE_BLACK_KING) fen += 'k';
+    if (pos.castling & CASTLE_BLACK_QUEEN) fen += 'q';
+    if (!pos.castling) fen += '-';
+
+    fen += ' ';
+    if (pos.epSquare == -1) fen += '-';
+    else fen += std::string(1, (char)('a' + colOf(pos.epSquare))) + (char)('8' - rowOf(pos.epSquare));
+
+    fen += " " + std::to_string(pos.halfmoveClock) + " " + std::to_string(pos.fullmoveNumber);
+    return fen;
+}
+
+// ───────────────────────────────────────────
+// Helper functions for check detections
+// ───────────────────────────────────────────
+// Every piece of either color attacking sq, given an occupancy. Passing an
+// occupancy without the king lets king moves see through their own square.
+Bitboard attackersTo(const Position &pos, int sq, Bitboard occupied) {
+    const Bitboard (*p)[7] = pos.pieces;
+    return (PAWN_ATTACKS[BLACK][sq] & p[WHITE][PAWN]) |
+           (PAWN_ATTACKS[WHITE][sq] & p[BLACK][PAWN]) |
+           (KNIGHT_ATTACKS[sq] & (p[WHITE][KNIGHT] | p[BLACK][KNIGHT])) |
+           (KING_ATTACKS[sq] & (p[WHITE][KING] | p[BLACK][KING])) |
+           (bishopAttacks(sq, occupied) & (p[WHITE][BISHOP] | p[BLACK][BISHOP] | p[WHITE][QUEEN] | p[BLACK][QUEEN])) |
+           (rookAttacks(sq, occupied) & (p[WHITE][ROOK] | p[BLACK][ROOK] | p[WHITE][QUEEN] | p[BLACK][QUEEN]));
+}
+
+// Looks outward from the target square with each piece's attack pattern.
+bool isSquareAttacked(const Position &pos, int sq, bool attackerIsWhite) {
+    int them = attackerIsWhite ? WHITE : BLACK;
+    const Bitboard *p = pos.pieces[them];
+
+    // A pawn of ours on sq would attack exactly the squares enemy pawns attack it from
+    if (PAWN_ATTACKS[them ^ 1][sq] & p[PAWN]) return true;
+    if (KNIGHT_ATTACKS[sq] & p[KNIGHT]) return true;
+    if (KING_ATTACKS[sq] & p[KING]) return true;
+    if (bishopAttacks(sq, pos.allPieces) & (p[BISHOP] | p[QUEEN])) return true;
+    if (rookAttacks(sq, pos.allPieces) & (p[ROOK] | p[QUEEN])) return true;
+    return false;
+}
+
+// ───────────────────────────────────────────
+// Hash check (build with -DDEBUG_HASH)
+// ───────────────────────────────────────────
+// Compares the incremental key with a full recomputation after every
+// make/unmake and stops at the first difference.
+#ifdef DEBUG_HASH
+#include <iostream>
+inline void verifyKey(const Position &pos, const char *where) {
+    if (pos.key != computeKey(pos)) {
+        std::cerr << "Zobrist key mismatch after " << where << std::endl;
+        std::abort();
+    }
+}
+#else
+inline void verifyKey(const Position &, const char *) {}
+#endif
+
+// ───────────────────────────────────────────
+// Make / Unmake
+// ───────────────────────────────────────────
+// makeMove pushes an UndoInfo and unmakeMove pops it, so the search can
+// walk the tree on a single Position without copying or rescanning it.
+void makeMove(Position &pos, Move m) {
+    int from = moveFrom(m), to = moveTo(m), flag = moveFlag(m);
+    int piece = pos.squares[from];
+    int us = colorOf(piece);
+
+    UndoInfo &undo = pos.history[pos.historyCount++];
+    undo.move = m;
+    undo.castling = (uint8_t)pos.castling;
+    undo.epSquare = (int8_t)pos.epSquare;
+    undo.halfmoveClock = (uint16_t)pos.halfmoveClock;
+    undo.key = pos.key;
+
+    // Take the old rights and en passant file out of the key
+    pos.key ^= ZOBRIST_CASTLING[pos.castling];
+    if (pos.epSquare != -1) pos.key ^= ZOBRIST_EP_FILE[colOf(pos.epSquare)];
+
+    // En passant takes the pawn beside the landing square
+    int captureSq = (flag == MOVE_EN_PASSANT) ? to + (us == WHITE ? 8 : -8) : to;
+    int captured = pos.squares[captureSq];
+    undo.captured = (int8_t)captured;
+
+    if (captured != 0) removePiece(pos, captureSq);
+    removePiece(pos, from);
+    if (isPromotion(m)) putPiece(pos, to, us == WHITE ? promotionType(m) : -promotionType(m));
+    else putPiece(pos, to, piece);
+
+    // Castling: the rook jumps over the king
+    if (flag == MOVE_CASTLING) {
+        int row = rowOf(to);
+        int rookFrom = squareOf(row, colOf(to) == 6 ? 7 : 0);
+        int rookTo = squareOf(row, colOf(to) == 6 ? 5 : 3);
+        int rook = pos.squares[rookFrom];
+        removePiece(pos, rookFrom);
+        putPiece(pos, rookTo, rook);
+    }
+
+    pos.castling &= CASTLING_KEEP[from] & CASTLING_KEEP[to];
+
+    // Only record an en passant square an enemy pawn can actually use
+    pos.epSquare = -1;
+    if (flag == MOVE_DOUBLE_PUSH) {
+        int ep = (from + to) / 2;
+        if (PAWN_ATTACKS[us][ep] & pos.pieces[us ^ 1][PAWN]) pos.epSquare = ep;
+    }
+
+    // ...and put the new ones in
+    pos.key ^= ZOBRIST_CASTLING[pos.castling];
+    if (pos.epSquare != -1) pos.key ^= ZOBRIST_EP_FILE[colOf(pos.epSquare)];
+    pos.key ^= ZOBRIST_BLACK_TO_MOVE;
+
+    if (captured != 0 || abs(piece) == PAWN) pos.halfmoveClock = 0;
+    else pos.halfmoveClock++;
+    if (us == BLACK) pos.fullmoveNumber++;
+    pos.whiteToMove = !pos.whiteToMove;
+    verifyKey(pos, "makeMove");
+}
+
+void unmakeMove(Position &pos) {
+    const UndoInfo &undo = pos.history[--pos.historyCount];
+    Move m = undo.move;
+    int from = moveFrom(m), to = moveTo(m), flag = moveFlag(m);
+
+    pos.whiteToMove = !pos.whiteToMove;
+    int us = pos.whiteToMove ? WHITE : BLACK;
+    if (us == BLACK) pos.fullmoveNumber--;
+
+    if (flag == MOVE_CASTLING) {
+        int row = rowOf(to);
+        int rookFrom = squareOf(row, colOf(to) == 6 ? 7 : 0);
+        int rookTo = squareOf(row, colOf(to) == 6 ? 5 : 3);
+        int rook = pos.squares[rookTo];
+        removePiece(pos, rookTo);
+        putPiece(pos, rookFrom, rook);
+    }
+
+    int piece = pos.squares[to];
+    if (isPromotion(m)) piece = (us == WHITE) ? PAWN : -PAWN;
+    removePiece(pos, to);
+    putPiece(pos, from, piece);
+
+    if (undo.captured != 0) {
+        int captureSq = (flag == MOVE_EN_PASSANT) ? to + (us == WHITE ? 8 : -8) : to;
+        putPiece(pos, captureSq, undo.captured);
+    }
+
+    pos.castling = undo.castling;
+    pos.epSquare = undo.epSquare;
+    pos.halfmoveClock = undo.halfmoveClock;
+    pos.key = undo.key;
+    verifyKey(pos, "unmakeMove");
+}
+
+// A null move passes the turn without moving anything. It is never legal
+// in a game; the search uses it to ask whether the opponent could do any
+// harm even if given a free move.
+void makeNullMove(Position &pos) {
+    UndoInfo &undo = pos.history[pos.historyCount++];
+    undo.move = NO_MOVE;
+    undo.captured = 0;
+    undo.castling = (uint8_t)pos.castling;
+    undo.epSquare = (int8_t)pos.epSquare;
+    undo.halfmoveClock = (uint16_t)pos.halfmoveClock;
+    undo.key = pos.key;
+
+    if (pos.epSquare != -1) pos.key ^= ZOBRIST_EP_FILE[colOf(pos.epSquare)];
+    pos.epSquare = -1;
+    pos.key ^= ZOBRIST_BLACK_TO_MOVE;
+    pos.halfmoveClock++;
+    pos.whiteToMove = !pos.whiteToMove;
+    verifyKey(pos, "makeNullMove");
+}
+
+void unmakeNullMove(Position &pos) {
+    const UndoInfo &undo = pos.history[--pos.historyCount];
+    pos.whiteToMove = !pos.whiteToMove;
+    pos.epSquare = undo.epSquare;
+    pos.halfmoveClock = undo.halfmoveClock;
+    pos.key = undo.key;
+}
+
+// ───────────────────────────────────────────
+// Keeping the undo stack small in long games
+// ───────────────────────────────────────────
+// The GUI and UCI positions keep every move played on the undo stack, and
+// nothing checks its size on the way in. Front ends call this after each
+// move: entries before the last capture or pawn move are dropped, and if
+// the game goes a long time without one, all but the newest (the search
+// looks at the previous move). The game never takes moves back, so
+// nothing is lost.
+const int MAX_KEPT_HISTORY = MAX_GAME_PLY / 2;
+
+void trimHistory(Position &pos) {
+    int keep = std::min(pos.historyCount, std::max(1, pos.halfmoveClock));
+    if (keep > MAX_KEPT_HISTORY) keep = 1;
+    int drop = pos.historyCount - keep;
+    for (int i = 0; i < keep; i++) pos.history[i] = pos.history[i + drop];
+    pos.historyCount = keep;
+}
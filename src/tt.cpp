@@ -0,0 +1,141 @@
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+
+// ──────────────────────────────────────────────
+// TRANSPOSITION TABLE
+// ──────────────────────────────────────────────
+// Remembers search results by Zobrist key so transposed positions are not
+// searched again. Entries are 8 bytes, eight to a 64-byte bucket, so one
+// probe touches a single cache line.
+//
+// All search threads share the table without locks. Each entry is read
+// and written as one 64-bit word, so a reader sees either the old entry or
+// the new one, never half of each. Two threads racing for the same slot
+// just lose one of the results.
+const int BOUND_NONE = 0;
+const int BOUND_UPPER = 1; // Score is at most this (no move reached alpha)
+const int BOUND_LOWER = 2; // Score is at least this (beta cutoff)
+const int BOUND_EXACT = 3;
+
+struct TTEntry {
+    uint16_t key16;   // Upper 16 bits of the key; the rest picked the bucket
+    Move move;
+    int16_t score;
+    uint8_t depth;
+    uint8_t boundAge; // Bound in the low 2 bits, search age above
+};
+static_assert(sizeof(TTEntry) == 8, "TT entries must pack into one 64-bit word");
+
+inline uint64_t packEntry(const TTEntry &e) {
+    uint64_t data;
+    std::memcpy(&data, &e, sizeof(data));
+    return data;
+}
+
+inline TTEntry unpackEntry(uint64_t data) {
+    TTEntry e;
+    std::memcpy(&e, &data, sizeof(e));
+    return e;
+}
+
+const int TT_BUCKET_SIZE = 8;
+
+struct alignas(64) TTBucket {
+    std::atomic<uint64_t> entries[TT_BUCKET_SIZE];
+};
+
+TTBucket* ttTable = nullptr;
+uint64_t ttBucketCount = 0;
+uint8_t ttAge = 0; // Bumped once per search, stored in the upper 6 bits
+
+// Size is rounded down to a power-of-two number of buckets
+void initTT(int megabytes) {
+    delete[] ttTable;
+    ttBucketCount = 1;
+    while (ttBucketCount * 2 * sizeof(TTBucket) <= (uint64_t)megabytes * 1024 * 1024) ttBucketCount *= 2;
+    ttTable = new TTBucket[ttBucketCount];
+    std::memset((void*)ttTable, 0, ttBucketCount * sizeof(TTBucket));
+}
+
+// Only while no search is running
+void clearTT() {
+    std::memset((void*)ttTable, 0, ttBucketCount * sizeof(TTBucket));
+    ttAge = 0;
+}
+
+// Called before the search threads start
+void ttNewSearch() {
+    ttAge = (ttAge + 4) & 0xFC;
+}
+
+// Low bits pick the bucket, the top 16 bits are stored in the entry
+inline TTBucket &ttBucket(uint64_t key) {
+    return ttTable[key & (ttBucketCount - 1)];
+}
+
+inline void prefetchTT(uint64_t key) {
+    __builtin_prefetch(&ttBucket(key));
+}
+
+inline bool probeTT(uint64_t key, TTEntry &found) {
+    TTBucket &bucket = ttBucket(key);
+    uint16_t key16 = (uint16_t)(key >> 48);
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        TTEntry e = unpackEntry(bucket.entries[i].load(std::memory_order_relaxed));
+        if (e.key16 == key16 && (e.boundAge & 3) != BOUND_NONE) {
+            found = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Replaces the entry for this key if there is one, otherwise the entry that
+// is shallowest once older searches are penalized.
+void storeTT(uint64_t key, Move move, int score, int depth, int bound) {
+    TTBucket &bucket = ttBucket(key);
+    uint16_t key16 = (uint16_t)(key >> 48);
+
+    int replace = 0;
+    TTEntry old = {};
+    int worst = 1 << 30;
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        TTEntry e = unpackEntry(bucket.entries[i].load(std::memory_order_relaxed));
+        if (e.key16 == key16 || (e.boundAge & 3) == BOUND_NONE) {
+            replace = i;
+            old = e;
+            break;
+        }
+        int age = ((ttAge - (e.boundAge & 0xFC)) & 0xFF) >> 2;
+        int value = e.depth - 8 * age;
+        if (value < worst) {
+            worst = value;
+            replace = i;
+            old = e;
+        }
+    }
+
+    // Keep the old best move if this search did not find one
+    if (move == NO_MOVE && old.key16 == key16) move = old.move;
+
+    TTEntry e;
+    e.key16 = key16;
+    e.move = move;
+    e.score = (int16_t)score;
+    e.depth = (uint8_t)depth;
+    e.boundAge = (uint8_t)(ttAge | bound);
+    bucket.entries[replace].store(packEntry(e), std::memory_order_relaxed);
+}
+
+// Per-mille of sampled entries written during the current search
+int ttHashfull() {
+    int used = 0, sampled = 0;
+    for (uint64_t b = 0; b < ttBucketCount && sampled < 1000; b++) {
+        for (int i = 0; i < TT_BUCKET_SIZE; i++, sampled++) {
+            TTEntry e = unpackEntry(ttTable[b].entries[i].load(std::memory_order_relaxed));
+            if ((e.boundAge & 3) != BOUND_NONE && (e.boundAge & 0xFC) == ttAge) used++;
+        }
+    }
+    return sampled ? used * 1000 / sampled : 0;
+}
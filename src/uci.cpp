@@ -0,0 +1,210 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "bitboard.cpp"
+#include "zobrist.cpp"
+#include "position.cpp"
+#include "move.cpp"
+#include "tt.cpp"
+#include "ai.cpp"
+
+// ──────────────────────────────
+// UCI front end
+// ──────────────────────────────
+// The main thread reads and parses commands; "go" hands the search to
+// searchWorker, so "stop", "isready" and "ponderhit" are answered while it
+// runs. Both threads print, so every line goes out through send().
+const int DEFAULT_HASH_MB = 64;
+const int MAX_HASH_MB = 4096;
+const int MAX_THREADS = 256;
+const int MOVE_OVERHEAD_MS = 50; // Kept back for GUI and network lag
+
+Position uciPosition;
+std::thread searchWorker;
+std::atomic<bool> uciStop{false};
+std::atomic<bool> uciPondering{false};
+std::atomic<bool> uciInfinite{false}; // "go infinite": hold bestmove until "stop"
+std::mutex outputMutex;
+
+void send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+// Stops a running search and waits for its bestmove
+void stopSearch() {
+    if (!searchWorker.joinable()) return;
+    uciStop = true;
+    uciPondering = false;
+    searchWorker.join();
+}
+
+// Runs on the search thread while uciPosition is left alone by the reader
+void sendIteration(const SearchInfo& progress, Move best) {
+    Move pv[MAX_PLY];
+    int length = principalVariation(uciPosition, best, pv, progress.depth);
+
+    std::ostringstream line;
+    long long nps = progress.timeMs ? progress.nodes * 1000 / progress.timeMs : 0;
+    line << "info depth " << progress.depth << " score " << uciScore(progress.score)
+         << " nodes " << progress.nodes << " nps " << nps << " time " << progress.timeMs
+         << " hashfull " << ttHashfull() << " pv";
+    for (int i = 0; i < length; i++) line << " " << moveToString(pv[i]);
+    send(line.str());
+}
+
+void runSearch(SearchLimits limits) {
+    Move best = getBestMove(uciPosition, limits);
+
+    // A search may end by itself (mate found, depth reached) while the GUI
+    // still expects it to run; bestmove waits for "stop" or "ponderhit".
+    while ((uciInfinite || uciPondering) && !uciStop)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    Move pv[2];
+    int length = principalVariation(uciPosition, best, pv, 2);
+    if (best == NO_MOVE) send("bestmove 0000");
+    else if (length == 2) send("bestmove " + moveToString(best) + " ponder " + moveToString(pv[1]));
+    else send("bestmove " + moveToString(best));
+}
+
+// Coordinate move such as "e7e8q", matched against the legal moves
+Move parseMove(const Position& pos, const std::string& text) {
+    MoveList moves;
+    generateAllMoves(pos, pos.whiteToMove, moves);
+    for (Move m : moves) if (moveToString(m) == text) return m;
+    return NO_MOVE;
+}
+
+// position [startpos | fen <fen>] [moves <move>...]
+void handlePosition(std::istringstream& in) {
+    std::string token, fen;
+    in >> token;
+    if (token == "startpos") {
+        fen = START_FEN;
+        in >> token; // "moves", if any
+    } else if (token == "fen") {
+        while (in >> token && token != "moves") fen += token + " ";
+    } else {
+        return;
+    }
+
+    if (!setPositionFromFen(uciPosition, fen)) {
+        send("info string invalid fen");
+        return;
+    }
+    while (in >> token) {
+        Move m = parseMove(uciPosition, token);
+        if (m == NO_MOVE) {
+            send("info string illegal move " + token);
+            return;
+        }
+        makeMove(uciPosition, m);
+        trimHistory(uciPosition);
+    }
+}
+
+// go [depth N] [nodes N] [movetime MS] [wtime MS] [btime MS] [winc MS]
+//    [binc MS] [movestogo N] [infinite] [ponder]
+void handleGo(std::istringstream& in) {
+    SearchLimits limits;
+    int time[2] = {0, 0}, inc[2] = {0, 0};
+    int movesToGo = 0, moveTime = 0;
+    bool infinite = false, ponder = false;
+
+    std::string token;
+    while (in >> token) {
+        if (token == "depth") in >> limits.maxDepth;
+        else if (token == "nodes") in >> limits.nodes;
+        else if (token == "movetime") in >> moveTime;
+        else if (token == "wtime") in >> time[WHITE];
+        else if (token == "btime") in >> time[BLACK];
+        else if (token == "winc") in >> inc[WHITE];
+        else if (token == "binc") in >> inc[BLACK];
+        else if (token == "movestogo") in >> movesToGo;
+        else if (token == "infinite") infinite = true;
+        else if (token == "ponder") ponder = true;
+    }
+
+    // A share of the clock plus most of the increment, never the whole clock
+    int us = uciPosition.whiteToMove ? WHITE : BLACK;
+    if (moveTime > 0) {
+        limits.timeMs = moveTime;
+    } else if (time[us] > 0) {
+        int budget = time[us] / (movesToGo > 0 ? movesToGo : 30) + inc[us] * 3 / 4;
+        limits.timeMs = std::max(1, std::min(budget, time[us] - MOVE_OVERHEAD_MS));
+    }
+    if (infinite) limits = SearchLimits();
+
+    uciStop = false;
+    uciInfinite = infinite;
+    uciPondering = ponder;
+    limits.stop = &uciStop;
+    limits.ponder = &uciPondering;
+    limits.onIteration = sendIteration;
+    searchWorker = std::thread(runSearch, limits);
+}
+
+// setoption name <Hash|Threads> value <N>
+void handleSetOption(std::istringstream& in) {
+    std::string token, name, value;
+    in >> token; // "name"
+    while (in >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    in >> value;
+
+    if (name == "Hash") initTT(std::max(1, std::min(std::atoi(value.c_str()), MAX_HASH_MB)));
+    else if (name == "Threads") setSearchThreads(std::max(1, std::min(std::atoi(value.c_str()), MAX_THREADS)));
+}
+
+int main() {
+    initBitboards();
+    initZobrist();
+    initTT(DEFAULT_HASH_MB);
+    setSearchThreads(1);
+    setPositionFromFen(uciPosition, START_FEN);
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+
+        if (command == "uci") {
+            send("id name ChessEngine");
+            send("id author KunwarPrabhat");
+            send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) +
+                 " min 1 max " + std::to_string(MAX_HASH_MB));
+            send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+            send("option name Ponder type check default false");
+            send("uciok");
+        } else if (command == "isready") {
+            send("readyok");
+        } else if (command == "ucinewgame") {
+            stopSearch();
+            clearTT();
+        } else if (command == "position") {
+            stopSearch();
+            handlePosition(in);
+        } else if (command == "go") {
+            stopSearch();
+            handleGo(in);
+        } else if (command == "stop") {
+            stopSearch();
+        } else if (command == "ponderhit") {
+            uciPondering = false;
+        } else if (command == "setoption") {
+            stopSearch();
+            handleSetOption(in);
+        } else if (command == "quit") {
+            break;
+        }
+    }
+    stopSearch();
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include <cstdint>
+
+// ──────────────────────────────────────────────
+// ZOBRIST KEYS
+// ──────────────────────────────────────────────
+// A position's key is the XOR of one random number per piece on a square,
+// plus the side to move, the castling rights and the en passant file.
+uint64_t ZOBRIST_PIECE[2][7][64]; // [color][pieceType][sq]
+uint64_t ZOBRIST_CASTLING[16];    // Indexed by the CASTLE_* bitmask
+uint64_t ZOBRIST_EP_FILE[8];
+uint64_t ZOBRIST_BLACK_TO_MOVE;
+
+// splitmix64 - fixed seed so keys are identical from run to run
+uint64_t zobristRandom() {
+    static uint64_t state = 0x2545F4914F6CDD1DULL;
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void initZobrist() {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+
+    for (int c = 0; c < 2; c++)
+        for (int t = 0; t < 7; t++)
+            for (int sq = 0; sq < 64; sq++)
+                ZOBRIST_PIECE[c][t][sq] = zobristRandom();
+    for (int i = 0; i < 16; i++) ZOBRIST_CASTLING[i] = zobristRandom();
+    for (int f = 0; f < 8; f++) ZOBRIST_EP_FILE[f] = zobristRandom();
+    ZOBRIST_BLACK_TO_MOVE = zobristRandom();
+}